@@ -96,6 +96,7 @@ namespace
   enum class ConfigOption {
     MAIN_SHOW_ALIAS,
     MAIN_REPO_LIST_COLUMNS,
+    MAIN_PARALLEL_DOWNLOADS,
 
     SOLVER_INSTALL_RECOMMENDS,
     SOLVER_FORCE_RESOLUTION_COMMANDS,
@@ -128,6 +129,7 @@ namespace
     static const std::vector<std::pair<std::string,ConfigOption>> _data = {
       { "main/showAlias",			ConfigOption::MAIN_SHOW_ALIAS			},
       { "main/repoListColumns",			ConfigOption::MAIN_REPO_LIST_COLUMNS		},
+      { "main/parallelDownloads",		ConfigOption::MAIN_PARALLEL_DOWNLOADS		},
       { "solver/installRecommends",		ConfigOption::SOLVER_INSTALL_RECOMMENDS		},
       { "solver/forceResolutionCommands",	ConfigOption::SOLVER_FORCE_RESOLUTION_COMMANDS	},
 
@@ -172,6 +174,7 @@ namespace
 
 Config::Config()
   : repo_list_columns("anr")
+  , parallelDownloads(1)
   , solver_installRecommends(!ZConfig::instance().solver_onlyRequires())
   , psCheckAccessDeleted(true)
   , do_colors		(false)
@@ -218,6 +221,17 @@ void Config::read( const std::string & file )
     if (!s.empty()) // TODO add some validation
       repo_list_columns = s;
 
+    s = augeas.getOption(asString( ConfigOption::MAIN_PARALLEL_DOWNLOADS ));
+    if (!s.empty())
+    {
+      parallelDownloads = str::strtonum<unsigned>( s );
+      if ( ! parallelDownloads )
+      {
+	WAR << "zypper.conf: main/parallelDownloads: invalid value '" << s << "'" << endl;
+	parallelDownloads = 1;
+      }
+    }
+
     // ---------------[ solver ]------------------------------------------------
 
     s = augeas.getOption(asString( ConfigOption::SOLVER_INSTALL_RECOMMENDS ));
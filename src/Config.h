@@ -30,6 +30,9 @@ struct Config
   /** Which columns to show in repo list by default (string of short options).*/
   std::string repo_list_columns;
 
+  /** zypper.conf: main.parallelDownloads (default number of download jobs, 1: don't fork) */
+  unsigned parallelDownloads;
+
   bool solver_installRecommends;
   std::set<ZypperCommand> solver_forceResolutionCommands;
 
@@ -0,0 +1,364 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <zypp/base/Logger.h>
+#include <zypp/PathInfo.h>
+#include <zypp/sat/Solvable.h>
+#include <zypp/sat/SolvAttr.h>
+#include <zypp/sat/LookupAttr.h>
+
+#include "FullTextIndex.h"
+
+// libzypp logger settings
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypper"
+
+using namespace zypp;
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+// File layout (host byte order, it's a local cache):
+//
+//   Header
+//   stamp		Header::stampSize bytes, padded to 4
+//   Entry[]		Header::entryCount, sorted by trigram
+//   postings		Header::postingsSize bytes
+//
+// Each entries postings are the offsets of the solvables containing
+// the trigram, in ascending order, delta and varint encoded.
+///////////////////////////////////////////////////////////////////
+
+struct FullTextIndex::Header
+{
+  char     magic[8];
+  uint32_t solvables;
+  uint32_t stampSize;
+  uint32_t entryCount;
+  uint32_t postingsSize;
+};
+
+struct FullTextIndex::Entry
+{
+  uint32_t trigram;
+  uint32_t offset;	///< into the postings
+  uint32_t count;	///< number of solvables
+};
+
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  const char magic[8] = { 'Z', 'Y', 'F', 'T', 'I', 'D', 'X', '1' };
+
+  inline size_t align4( size_t size_r )
+  { return ( size_r + 3 ) & ~size_t(3); }
+
+  /** Call \a fnc_r for each indexable trigram in \a text_r. */
+  template <class Fnc_>
+  void forEachTrigram( boost::string_ref text_r, Fnc_ fnc_r )
+  {
+    uint32_t trigram = 0;
+    unsigned valid = 0;	// number of preceding indexable bytes
+    for ( unsigned char ch : text_r )
+    {
+      if ( ch & 0x80 )
+      {
+	valid = 0;
+	continue;
+      }
+      if ( ch >= 'A' && ch <= 'Z' )
+	ch += 'a' - 'A';
+      trigram = ( ( trigram << 8 ) | ch ) & 0xffffff;
+      if ( ++valid >= 3 )
+	fnc_r( trigram );
+    }
+  }
+
+  /** The stamp the index is valid for: the repo caches cookie. */
+  std::string readStamp( const Pathname & cacheDir_r )
+  {
+    std::ifstream in( ( cacheDir_r / "cookie" ).c_str() );
+    std::ostringstream str;
+    str << in.rdbuf();
+    return str.str();
+  }
+
+  /** A trigrams postings while building the index. */
+  struct Posting
+  {
+    Posting() : last( 0 ), count( 0 ) {}
+
+    void add( uint32_t offset_r )
+    {
+      if ( count && offset_r == last )
+	return;	// already added for this solvable
+      uint32_t delta = offset_r - last;
+      while ( delta >= 0x80 )
+      {
+	bytes.push_back( char( delta | 0x80 ) );
+	delta >>= 7;
+      }
+      bytes.push_back( char( delta ) );
+      last = offset_r;
+      ++count;
+    }
+
+    std::string bytes;
+    uint32_t last;
+    uint32_t count;
+  };
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+std::string FullTextIndex::fileName( Content content_r )
+{
+  return( content_r == FILES ? "filelist.idx" : "fulltext.idx" );
+}
+
+bool FullTextIndex::isIndexable( boost::string_ref text_r )
+{
+  bool ret = false;
+  forEachTrigram( text_r, [&ret]( uint32_t ) { ret = true; } );
+  return ret;
+}
+
+bool FullTextIndex::build( const Repository & repo_r, const Pathname & cacheDir_r, Content content_r )
+{
+  std::string stamp( readStamp( cacheDir_r ) );
+  if ( stamp.empty() )
+  {
+    WAR << "No cookie in " << cacheDir_r << ", not building the full-text index" << endl;
+    return false;
+  }
+
+  std::unordered_map<uint32_t,Posting> postings;
+  unsigned solvables = 0;
+  unsigned firstId = repo_r.solvablesEmpty() ? 0 : repo_r.solvablesBegin()->id();
+  for_( it, repo_r.solvablesBegin(), repo_r.solvablesEnd() )
+  {
+    ++solvables;
+    uint32_t offset = it->id() - firstId;
+    auto add = [&postings,offset]( uint32_t trigram_r ) { postings[trigram_r].add( offset ); };
+    if ( content_r == FILES )
+    {
+      sat::LookupAttr files( sat::SolvAttr::filelist, *it );
+      for_( file, files.begin(), files.end() )
+	forEachTrigram( file.c_str(), add );
+    }
+    else
+    {
+      forEachTrigram( it->lookupStrAttribute( sat::SolvAttr::summary ), add );
+      forEachTrigram( it->lookupStrAttribute( sat::SolvAttr::description ), add );
+    }
+  }
+
+  std::vector<uint32_t> trigrams;
+  trigrams.reserve( postings.size() );
+  for ( const auto & posting : postings )
+    trigrams.push_back( posting.first );
+  std::sort( trigrams.begin(), trigrams.end() );
+
+  std::vector<Entry> entries;
+  entries.reserve( trigrams.size() );
+  uint32_t offset = 0;
+  for ( uint32_t trigram : trigrams )
+  {
+    const Posting & posting( postings[trigram] );
+    entries.push_back( Entry{ trigram, offset, posting.count } );
+    offset += posting.bytes.size();
+  }
+
+  Header header;
+  ::memcpy( header.magic, magic, sizeof(magic) );
+  header.solvables = solvables;
+  header.stampSize = stamp.size();
+  header.entryCount = entries.size();
+  header.postingsSize = offset;
+
+  Pathname file( cacheDir_r / fileName( content_r ) );
+  Pathname tmp( file.extend( ".new" ) );
+  {
+    std::ofstream out( tmp.c_str(), std::ios::binary );
+    out.write( reinterpret_cast<const char *>( &header ), sizeof(header) );
+    out.write( stamp.c_str(), stamp.size() );
+    out.write( "\0\0\0", align4( stamp.size() ) - stamp.size() );
+    out.write( reinterpret_cast<const char *>( entries.data() ), entries.size() * sizeof(Entry) );
+    for ( uint32_t trigram : trigrams )
+    {
+      const std::string & bytes( postings[trigram].bytes );
+      out.write( bytes.data(), bytes.size() );
+    }
+    if ( ! out.flush() )
+    {
+      WAR << "Can't write full-text index " << tmp << endl;
+      filesystem::unlink( tmp );
+      return false;
+    }
+  }
+  if ( filesystem::rename( tmp, file ) != 0 )
+  {
+    WAR << "Can't write full-text index " << file << endl;
+    filesystem::unlink( tmp );
+    return false;
+  }
+  MIL << "Full-text index " << file << ": " << solvables << " solvables, " << entries.size()
+      << " trigrams, " << offset << " bytes postings" << endl;
+  return true;
+}
+
+FullTextIndex::FullTextIndex( const Repository & repo_r, const Pathname & cacheDir_r, Content content_r )
+: _repo( repo_r )
+, _firstId( repo_r.solvablesEmpty() ? 0 : repo_r.solvablesBegin()->id() )
+, _data( nullptr )
+, _size( 0 )
+, _entries( nullptr )
+, _entryCount( 0 )
+, _postings( nullptr )
+{
+  Pathname file( cacheDir_r / fileName( content_r ) );
+  int fd = ::open( file.c_str(), O_RDONLY|O_CLOEXEC );
+  if ( fd < 0 )
+  {
+    DBG << "No full-text index " << file << endl;
+    return;
+  }
+  struct stat st;
+  if ( ::fstat( fd, &st ) == 0 && size_t(st.st_size) >= sizeof(Header) )
+  {
+    void * addr = ::mmap( nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    if ( addr != MAP_FAILED )
+    {
+      _data = static_cast<const char *>( addr );
+      _size = st.st_size;
+    }
+  }
+  ::close( fd );
+  if ( ! _data )
+  {
+    WAR << "Can't map full-text index " << file << endl;
+    return;
+  }
+
+  const Header & header( *reinterpret_cast<const Header *>( _data ) );
+  size_t entriesAt = sizeof(Header) + align4( header.stampSize );
+  size_t postingsAt = entriesAt + size_t(header.entryCount) * sizeof(Entry);
+  std::string stamp( readStamp( cacheDir_r ) );
+
+  if ( ::memcmp( header.magic, magic, sizeof(magic) ) != 0
+    || postingsAt > _size
+    || postingsAt + header.postingsSize != _size )
+  {
+    WAR << "Ignore malformed full-text index " << file << endl;
+  }
+  else if ( header.solvables != repo_r.solvablesSize()
+	 || stamp.size() != header.stampSize
+	 || stamp.compare( 0, stamp.size(), _data + sizeof(Header), header.stampSize ) != 0 )
+  {
+    MIL << "Ignore outdated full-text index " << file << endl;
+  }
+  else
+  {
+    _entries = reinterpret_cast<const Entry *>( _data + entriesAt );
+    _entryCount = header.entryCount;
+    _postings = reinterpret_cast<const unsigned char *>( _data + postingsAt );
+    DBG << "Using full-text index " << file << endl;
+    return;
+  }
+
+  ::munmap( const_cast<char *>( _data ), _size );
+  _data = nullptr;
+  _size = 0;
+}
+
+FullTextIndex::~FullTextIndex()
+{
+  if ( _data )
+    ::munmap( const_cast<char *>( _data ), _size );
+}
+
+const FullTextIndex::Entry * FullTextIndex::find( uint32_t trigram_r ) const
+{
+  const Entry * end = _entries + _entryCount;
+  const Entry * it = std::lower_bound( _entries, end, trigram_r,
+				       []( const Entry & lhs, uint32_t rhs ) { return lhs.trigram < rhs; } );
+  return( it != end && it->trigram == trigram_r ? it : nullptr );
+}
+
+void FullTextIndex::decode( const Entry & entry_r, std::vector<uint32_t> & result_r ) const
+{
+  result_r.clear();
+  result_r.reserve( entry_r.count );
+  const unsigned char * ptr = _postings + entry_r.offset;
+  uint32_t offset = 0;
+  for ( uint32_t i = 0; i < entry_r.count; ++i )
+  {
+    uint32_t delta = 0;
+    for ( unsigned shift = 0; ; shift += 7 )
+    {
+      delta |= uint32_t( *ptr & 0x7f ) << shift;
+      if ( ! ( *ptr++ & 0x80 ) )
+	break;
+    }
+    offset += delta;
+    result_r.push_back( offset );
+  }
+}
+
+void FullTextIndex::candidates( boost::string_ref text_r, std::vector<sat::Solvable> & result_r ) const
+{
+  if ( ! _data )
+    return;
+
+  std::vector<uint32_t> trigrams;
+  forEachTrigram( text_r, [&trigrams]( uint32_t trigram_r ) { trigrams.push_back( trigram_r ); } );
+  std::sort( trigrams.begin(), trigrams.end() );
+  trigrams.erase( std::unique( trigrams.begin(), trigrams.end() ), trigrams.end() );
+
+  std::vector<const Entry *> entries;
+  for ( uint32_t trigram : trigrams )
+  {
+    const Entry * entry = find( trigram );
+    if ( ! entry )
+      return;	// no solvable contains this trigram
+    entries.push_back( entry );
+  }
+  if ( entries.empty() )
+    return;
+
+  // shortest list first
+  std::sort( entries.begin(), entries.end(),
+	     []( const Entry * lhs, const Entry * rhs ) { return lhs->count < rhs->count; } );
+
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> next;
+  std::vector<uint32_t> common;
+  decode( *entries.front(), offsets );
+  for ( auto it = entries.begin() + 1; it != entries.end() && ! offsets.empty(); ++it )
+  {
+    decode( **it, next );
+    common.clear();
+    std::set_intersection( offsets.begin(), offsets.end(), next.begin(), next.end(), std::back_inserter( common ) );
+    offsets.swap( common );
+  }
+
+  for ( uint32_t offset : offsets )
+  {
+    sat::Solvable solv( _firstId + offset );
+    if ( solv.repository() == _repo )
+      result_r.push_back( solv );
+  }
+}
@@ -0,0 +1,96 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_FULLTEXTINDEX_H_
+#define ZYPPER_FULLTEXTINDEX_H_
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/Pathname.h>
+#include <zypp/Repository.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class FullTextIndex
+/// \brief Trigram index of a repos summaries and descriptions or file lists.
+///
+/// The index is built by 'refresh' and stored in the repos solv cache
+/// directory next to the \c solv file. It maps each trigram of the
+/// (ASCII lowercased) summary and description texts, or of the full
+/// file paths, to the solvables containing it. A search maps the index
+/// and intersects the lists of the searched strings trigrams. The
+/// resulting candidates are a superset of the matches, they still need
+/// to be checked.
+///
+/// The index stores the repo caches \c cookie and the number of
+/// solvables it was built for. It is ignored if they do not match
+/// the loaded repo (e.g. the cache was refreshed, but the index not
+/// rebuilt), so callers must be prepared to search without it.
+///
+/// Trigrams containing non-ASCII bytes are not indexed, as their case
+/// folding depends on the locale.
+///////////////////////////////////////////////////////////////////
+class FullTextIndex : private zypp::base::NonCopyable
+{
+public:
+  /** The indexed attributes. */
+  enum Content
+  {
+    TEXTS,	///< summaries and descriptions
+    FILES	///< file lists (full paths)
+  };
+
+  /** The index files name in the solv cache directory. */
+  static std::string fileName( Content content_r );
+
+  /** Build the index of the loaded \a repo_r in \a cacheDir_r (the repos solv cache directory).
+   * \returns \c false if the index could not be written.
+   */
+  static bool build( const zypp::Repository & repo_r, const zypp::Pathname & cacheDir_r, Content content_r = TEXTS );
+
+  /** Whether \a text_r contains at least one indexed trigram, so \ref candidates can narrow the search. */
+  static bool isIndexable( boost::string_ref text_r );
+
+public:
+  /** Ctor: map the index of \a repo_r in \a cacheDir_r. Check \ref isValid. */
+  FullTextIndex( const zypp::Repository & repo_r, const zypp::Pathname & cacheDir_r, Content content_r = TEXTS );
+
+  /** Dtor: unmap the index. */
+  ~FullTextIndex();
+
+  /** Whether the index exists and is up to date. */
+  bool isValid() const
+  { return _data; }
+
+  /** The solvables of the repo whose indexed attributes may contain \a text_r.
+   * The candidates are appended to \a result_r in pool order. \a text_r must be
+   * \ref isIndexable.
+   */
+  void candidates( boost::string_ref text_r, std::vector<zypp::sat::Solvable> & result_r ) const;
+
+private:
+  struct Header;
+  struct Entry;
+
+  const Entry * find( uint32_t trigram_r ) const;
+  void decode( const Entry & entry_r, std::vector<uint32_t> & result_r ) const;
+
+private:
+  zypp::Repository _repo;
+  unsigned _firstId;	///< solvables are stored as offset to the repos first solvable id
+  const char * _data;	///< mapped file, \c NULL if not valid
+  size_t _size;
+  const Entry * _entries;
+  unsigned _entryCount;
+  const unsigned char * _postings;
+};
+
+#endif // ZYPPER_FULLTEXTINDEX_H_
@@ -0,0 +1,76 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/ResPool.h>
+#include <zypp/Patch.h>
+
+#include "IssueIndex.h"
+
+// libzypp logger settings
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypper"
+
+using namespace zypp;
+using std::endl;
+
+IssueIndex::IssueIndex()
+: _size( 0 )
+{
+  unsigned patches = 0;
+  for_( it, ResPool::instance().byKindBegin<Patch>(), ResPool::instance().byKindEnd<Patch>() )
+  {
+    Patch::constPtr patch( asKind<Patch>( *it ) );
+    if ( ! patch )
+      continue;
+    ++patches;
+    for_( ref, patch->referencesBegin(), patch->referencesEnd() )
+      add( patch->satSolvable(), ref.type(), ref.id() );
+  }
+  MIL << "Issue index: " << _size << " references of " << patches << " patches" << endl;
+}
+
+void IssueIndex::add( sat::Solvable patch_r, const std::string & type_r, const std::string & id_r )
+{
+  IdString type( type_r );
+  _byId[str::toLower( id_r )].push_back( Ref{ patch_r, type } );
+  std::vector<sat::Solvable> & byType( _byType[type_r] );
+  if ( byType.empty() || byType.back() != patch_r )
+    byType.push_back( patch_r );
+  ++_size;
+}
+
+void IssueIndex::find( const std::string & type_r, const std::string & id_r, std::vector<sat::Solvable> & result_r ) const
+{
+  size_t begin = result_r.size();
+  if ( id_r.empty() )
+  {
+    auto it = _byType.find( type_r );
+    if ( it != _byType.end() )
+      result_r.insert( result_r.end(), it->second.begin(), it->second.end() );
+  }
+  else
+  {
+    auto it = _byId.find( str::toLower( id_r ) );
+    if ( it != _byId.end() )
+    {
+      for ( const Ref & ref : it->second )
+      {
+	if ( type_r.empty() || ref.type == type_r )
+	  result_r.push_back( ref.patch );
+      }
+    }
+  }
+
+  std::sort( result_r.begin() + begin, result_r.end(),
+	     []( const sat::Solvable & lhs, const sat::Solvable & rhs )->bool
+	     { return lhs.id() < rhs.id(); } );
+  result_r.erase( std::unique( result_r.begin() + begin, result_r.end() ), result_r.end() );
+}
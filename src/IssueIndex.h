@@ -0,0 +1,67 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_ISSUEINDEX_H_
+#define ZYPPER_ISSUEINDEX_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/IdString.h>
+#include <zypp/sat/Solvable.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class IssueIndex
+/// \brief In-memory index of the patches update references (issue type and ID).
+///
+/// Built once by walking the update references of all patches in the
+/// pool. Afterwards the patches fixing an issue are a hash lookup,
+/// instead of a \ref zypp::PoolQuery over all references per issue.
+///
+/// Issue IDs are looked up case insensitive (ASCII), issue types exact
+/// (like the \c --bugzilla and \c --cve handling always did).
+///
+/// \code
+///   IssueIndex index;
+///   std::vector<sat::Solvable> patches;
+///   index.find( "cve", "CVE-2015-0235", patches );
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class IssueIndex : private zypp::base::NonCopyable
+{
+public:
+  /** Ctor: index the update references of all patches in the pool. */
+  IssueIndex();
+
+  /** Add a reference (for building custom indexes). */
+  void add( zypp::sat::Solvable patch_r, const std::string & type_r, const std::string & id_r );
+
+  /** Append the patches having a reference with ID \a id_r and type \a type_r
+   * to \a result_r. An empty \a type_r matches any type, an empty \a id_r any
+   * reference of type \a type_r. Each patch is appended once, in pool order.
+   */
+  void find( const std::string & type_r, const std::string & id_r, std::vector<zypp::sat::Solvable> & result_r ) const;
+
+  /** Number of indexed references. */
+  unsigned size() const
+  { return _size; }
+
+private:
+  struct Ref
+  {
+    zypp::sat::Solvable patch;
+    zypp::IdString type;
+  };
+
+  std::unordered_map<std::string,std::vector<Ref>> _byId;	///< lowercased ID
+  std::unordered_map<std::string,std::vector<zypp::sat::Solvable>> _byType;
+  unsigned _size;
+};
+
+#endif // ZYPPER_ISSUEINDEX_H_
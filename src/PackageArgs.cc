@@ -10,6 +10,9 @@
  */
 
 #include <iostream>
+#include <sstream>
+#include <iterator>
+#include <unordered_set>
 #include <zypp/base/Logger.h>
 
 #include "PackageArgs.h"
@@ -37,62 +40,153 @@ PackageArgs::PackageArgs(
   argsToCaps(kind);
 }
 
+PackageArgs::PackageArgs(
+    istream & manifest,
+    const zypp::ResKind & kind,
+    const Options & opts)
+  : zypper(*Zypper::instance()), _opts(opts)
+{
+  preprocess(zypper.arguments());
+
+  // The manifest may be huge: read it at once and pass views into the
+  // buffer down, rather than a string per spec. Its specs are kept in
+  // a plain vector rather than in _args.
+  ostringstream buffer;
+  buffer << manifest.rdbuf();
+  const string & text(buffer.str());
+
+  vector<boost::string_ref> specs(_args.begin(), _args.end());
+  deque<string> joined;
+  readManifest(text, specs, joined);
+
+  _dos.reserve(specs.size());
+  for_(it, specs.begin(), specs.end())
+    argToCaps(*it, kind);
+}
+
 // ---------------------------------------------------------------------------
 
-void PackageArgs::preprocess(const vector<string> & args)
+namespace
 {
-  vector<string>::size_type argc = args.size();
-
-  string tmp;
-  string arg;
-  bool op = false;
-  for(unsigned i = 0; i < argc; ++i)
+  /** An argument being compiled: a view into the original arguments,
+   * or into a scratch buffer once something got joined. */
+  class JoinedArg
   {
-    tmp = args[i];
-
-    if (op)
-    {
-      arg += tmp;
-      op = false;
-      tmp.clear();
-    }
-    // standalone operator
-    else if (tmp == "=" || tmp == "==" || tmp == "<"
-            || tmp == ">" || tmp == "<=" || tmp == ">=")
+  public:
+    void assign(boost::string_ref word)
     {
-      // not at the start or the end
-      if (i && i < argc - 1)
-        op = true;
+      _view = word;
+      _joined = false;
     }
-    // operator at the end of a random string, e.g. 'zypper='
-    else if (tmp.find_last_of("=<>") == tmp.size() - 1 && i < argc - 1)
+
+    void append(boost::string_ref word)
     {
-      if (!arg.empty())
-        _args.insert(arg);
-      arg = tmp;
-      op = true;
-      continue;
+      if (!_joined)
+      {
+        _buffer.assign(_view.begin(), _view.end());
+        _joined = true;
+      }
+      _buffer.append(word.begin(), word.end());
+      _view = _buffer;
     }
-    // operator at the start of a random string e.g. '>=3.2.1'
-    else if (i && tmp.find_first_of("=<>") == 0)
+
+    bool empty() const
+    { return _view.empty(); }
+    bool joined() const
+    { return _joined; }
+    boost::string_ref view() const
+    { return _view; }
+
+  private:
+    boost::string_ref _view;
+    std::string _buffer;
+    bool _joined = false;
+  };
+
+  /**
+   * Join \a args at comparison operators ('=', '>=', and the like) and
+   * pass each resulting argument to \a fnc, along with whether it was
+   * joined. Unjoined arguments are views into \a args, joined ones are
+   * only valid during the call.
+   */
+  template <class Fnc_>
+  void joinOperators(const vector<boost::string_ref> & args, Fnc_ fnc)
+  {
+    vector<boost::string_ref>::size_type argc = args.size();
+
+    boost::string_ref tmp;
+    JoinedArg arg;
+    bool op = false;
+    for(unsigned i = 0; i < argc; ++i)
     {
-      arg += tmp;
-      tmp.clear();
-      op = false;
+      tmp = args[i];
+
+      if (op)
+      {
+        arg.append(tmp);
+        op = false;
+        tmp.clear();
+      }
+      // standalone operator
+      else if (tmp == "=" || tmp == "==" || tmp == "<"
+              || tmp == ">" || tmp == "<=" || tmp == ">=")
+      {
+        // not at the start or the end
+        if (i && i < argc - 1)
+          op = true;
+      }
+      // operator at the end of a random string, e.g. 'zypper='
+      else if (tmp.find_last_of("=<>") == tmp.size() - 1 && i < argc - 1)
+      {
+        if (!arg.empty())
+          fnc(arg.view(), arg.joined());
+        arg.assign(tmp);
+        op = true;
+        continue;
+      }
+      // operator at the start of a random string e.g. '>=3.2.1'
+      else if (i && tmp.find_first_of("=<>") == 0)
+      {
+        arg.append(tmp);
+        tmp.clear();
+        op = false;
+      }
+
+      if (op)
+        arg.append(tmp);
+      else
+      {
+        if (!arg.empty())
+          fnc(arg.view(), arg.joined());
+        arg.assign(tmp);
+      }
     }
 
-    if (op)
-      arg += tmp;
-    else
+    if (!arg.empty())
+      fnc(arg.view(), arg.joined());
+  }
+
+  /** FNV-1a, std::hash has no string_ref overload */
+  struct StringRefHash
+  {
+    size_t operator()(boost::string_ref str) const
     {
-      if (!arg.empty())
-        _args.insert(arg);
-      arg = tmp;
+      size_t hash = 2166136261U;
+      for (unsigned char ch : str)
+        hash = (hash ^ ch) * 16777619U;
+      return hash;
     }
-  }
+  };
 
-  if (!arg.empty())
-    _args.insert(arg);
+  inline bool isBlank(char ch)
+  { return ch == ' ' || ch == '\t' || ch == '\r'; }
+} // namespace
+
+void PackageArgs::preprocess(const vector<string> & args)
+{
+  vector<boost::string_ref> words(args.begin(), args.end());
+  joinOperators(words, [this](boost::string_ref arg, bool)
+  { _args.insert(arg.to_string()); });
 
   DBG << "args received: ";
   copy(args.begin(), args.end(), ostream_iterator<string>(DBG, " "));
@@ -105,6 +199,57 @@ void PackageArgs::preprocess(const vector<string> & args)
 
 // ---------------------------------------------------------------------------
 
+void PackageArgs::readManifest(boost::string_ref manifest,
+    vector<boost::string_ref> & specs, deque<string> & joined)
+{
+  unordered_set<boost::string_ref, StringRefHash> seen(specs.begin(), specs.end());
+  unsigned lines = 0;
+  unsigned read = 0;
+  vector<boost::string_ref> words;
+  while (!manifest.empty())
+  {
+    ++lines;
+    boost::string_ref::size_type eol = manifest.find('\n');
+    boost::string_ref line(manifest.substr(0, eol));
+    manifest.remove_prefix(eol == boost::string_ref::npos ? manifest.size() : eol + 1);
+
+    words.clear();
+    for (boost::string_ref::size_type pos = 0; pos < line.size(); )
+    {
+      if (isBlank(line[pos]))
+      {
+        ++pos;
+        continue;
+      }
+      boost::string_ref::size_type end = pos;
+      while (end < line.size() && !isBlank(line[end]))
+        ++end;
+      words.push_back(line.substr(pos, end - pos));
+      pos = end;
+    }
+    if (words.empty() || words.front()[0] == '#')
+      continue;
+
+    joinOperators(words, [&](boost::string_ref arg, bool isJoined)
+    {
+      ++read;
+      if (seen.count(arg))
+        return;
+      if (isJoined)
+      {
+        joined.push_back(arg.to_string());
+        arg = joined.back();
+      }
+      seen.insert(arg);
+      specs.push_back(arg);
+    });
+  }
+  MIL << "manifest: " << read << " specs in " << lines << " lines, "
+      << specs.size() << " unique" << endl;
+}
+
+// ---------------------------------------------------------------------------
+
 static bool
 remove_duplicate(
     PackageArgs::PackageSpecSet & set, const PackageSpec & obj)
@@ -123,150 +268,245 @@ remove_duplicate(
 
 void PackageArgs::argsToCaps(const zypp::ResKind & kind)
 {
-  bool dont;
-  string arg, repo;
   for_(it, _args.begin(), _args.end())
+    argToCaps(*it, kind);
+}
+
+void PackageArgs::argToCaps(boost::string_ref orig, const zypp::ResKind & kind)
+{
+  bool dont;
+  boost::string_ref view(orig);
+  string repo;
+
+  PackageSpec spec;
+  spec.orig_str = orig.to_string();
+
+  // For given arguments:
+  //    +vim
+  //    -emacs
+  //    libdnet1.i586
+  //    perl-devel:perl(Digest::MD5)
+  //    ~non-oss:opera-2:10.1-1.2.gcc44.x86_64
+  //    zypper>=1.2.15
+  //
+  // 1) check for and remove the install/remove modifiers
+  //    vim                          (install)
+  //    emacs                        (remove)
+  //    perl-devel:perl(Digest::MD5) (install/remove according to command)
+  //
+  // 2) check for and remove the repo specifier at the beginning of the arg
+  //    vim                           (no repo)
+  //    libdnet1.i586                 (no repo)
+  //    perl(Digest::MD5)             (perl-devel repo)
+  //    opera-2:10.1-1.2.gcc44.x86_64 (non-oss repo)
+  //    note: repo can be specified by number/alias/name/URI, use match_repo()
+  //
+  // 3) parse the rest of the string as standard zypp package specifier into
+  //    a Capability using Capability::guessPackageSpec
+  //                                  name, arch, op, evr, kind
+  //    vim                           'vim', '', '', '', 'package'
+  //    libdnet1.i586                 'libdnet', 'i586', '', '', 'package'
+  //    perl(Digest::MD5)             'perl(Digest::MD5)', '', '', '', 'package'
+  //    opera-2:10.1-1.2.gcc44.x86_64 'opera', 'x86_64', '=', '2:10.1-1.2.gcc44', 'package'
+  //    zypper>=1.2.15                'zypper', '', '>=', '1.2.15', 'package'
+  //    note: depends on whether the cap in the pool
+
+
+  // check for and remove the install/remove modifiers
+  // sort as do/dont
+
+  if (view[0] == '+' || view[0] == '~')
   {
-    arg = *it;
-    repo.clear();
-
-    PackageSpec spec;
-    spec.orig_str = arg;
-
-    // For given arguments:
-    //    +vim
-    //    -emacs
-    //    libdnet1.i586
-    //    perl-devel:perl(Digest::MD5)
-    //    ~non-oss:opera-2:10.1-1.2.gcc44.x86_64
-    //    zypper>=1.2.15
-    //
-    // 1) check for and remove the install/remove modifiers
-    //    vim                          (install)
-    //    emacs                        (remove)
-    //    perl-devel:perl(Digest::MD5) (install/remove according to command)
-    //
-    // 2) check for and remove the repo specifier at the beginning of the arg
-    //    vim                           (no repo)
-    //    libdnet1.i586                 (no repo)
-    //    perl(Digest::MD5)             (perl-devel repo)
-    //    opera-2:10.1-1.2.gcc44.x86_64 (non-oss repo)
-    //    note: repo can be specified by number/alias/name/URI, use match_repo()
-    //
-    // 3) parse the rest of the string as standard zypp package specifier into
-    //    a Capability using Capability::guessPackageSpec
-    //                                  name, arch, op, evr, kind
-    //    vim                           'vim', '', '', '', 'package'
-    //    libdnet1.i586                 'libdnet', 'i586', '', '', 'package'
-    //    perl(Digest::MD5)             'perl(Digest::MD5)', '', '', '', 'package'
-    //    opera-2:10.1-1.2.gcc44.x86_64 'opera', 'x86_64', '=', '2:10.1-1.2.gcc44', 'package'
-    //    zypper>=1.2.15                'zypper', '', '>=', '1.2.15', 'package'
-    //    note: depends on whether the cap in the pool
-
-
-    // check for and remove the install/remove modifiers
-    // sort as do/dont
-
-    if (arg[0] == '+' || arg[0] == '~')
-    {
-      dont = false;
-      arg.erase(0, 1);
-    }
-    else if (arg[0] == '-' || arg[0] == '!')
-    {
-      dont = true;
-      arg.erase(0, 1);
-    }
-    else if (_opts.do_by_default)
-      dont = false;
-    else
-      dont = true;
+    dont = false;
+    view.remove_prefix(1);
+  }
+  else if (view[0] == '-' || view[0] == '!')
+  {
+    dont = true;
+    view.remove_prefix(1);
+  }
+  else if (_opts.do_by_default)
+    dont = false;
+  else
+    dont = true;
 
-    // check for and remove the 'repo:' prefix
-    // ignore colons coming after '(' or '=' (bnc #433679)
-    // e.g. 'perl(Digest::MD5)', or 'opera=2:10.00-4102.gcc4.shared.qt3'
+  // check for and remove the 'repo:' prefix
+  // ignore colons coming after '(' or '=' (bnc #433679)
+  // e.g. 'perl(Digest::MD5)', or 'opera=2:10.00-4102.gcc4.shared.qt3'
 
-    string::size_type pos;
-    if ((pos = arg.find(':')) != string::npos && arg.find_first_of("(=") > pos)
+  string::size_type pos;
+  if ((pos = view.find(':')) != boost::string_ref::npos && view.find_first_of("(=") > pos)
+  {
+    repo = view.substr(0, pos).to_string();
+    auto match = _repoMatches.find(repo);
+    if (match == _repoMatches.end())
+      match = _repoMatches.insert(make_pair(repo, match_repo(zypper, repo))).first;
+    if (match->second)
     {
-      repo = arg.substr(0, pos);
-      if (match_repo(zypper, repo))
-      {
-        arg = arg.substr(pos + 1);
-        DBG << "got repo '" << repo << "' for '" << arg << "'" << endl;
-      }
-      // not a repo, continue as usual
-      else
-        repo.clear();
+      view.remove_prefix(pos + 1);
+      DBG << "got repo '" << repo << "' for '" << view << "'" << endl;
     }
+    // not a repo, continue as usual
+    else
+      repo.clear();
+  }
+  string arg(view.to_string());
+
+  // parse the rest of the string as standard zypp package specifier
+  Capability parsedcap;
+  if (kind == ResKind::package ||
+      ( (pos = arg.find(':')) != string::npos && arg.find_first_of("(=") > pos) )
+    parsedcap = Capability::guessPackageSpec(arg, spec.modified);
+  else
+    // prepend the kind for non-packages if not already there (bnc #640399)
+    parsedcap = Capability::guessPackageSpec(
+        kind.asString() + ":" + arg, spec.modified);
 
-    // parse the rest of the string as standard zypp package specifier
-    Capability parsedcap;
-    if (kind == ResKind::package ||
-        ( (pos = arg.find(':')) != string::npos && arg.find_first_of("(=") > pos) )
-      parsedcap = Capability::guessPackageSpec(arg, spec.modified);
+  if (spec.modified)
+  {
+    string msg = str::form(
+        _("'%s' not found in package names. Trying '%s'."),
+        arg.c_str(), parsedcap.asString().c_str());
+    zypper.out().info(msg,Out::HIGH); // TODO this should not be called here
+    DBG << "'" << arg << "' not found, trying '" << parsedcap <<  "'" << endl;
+  }
+
+  // set the right kind (bnc #580571)
+  // prefer those specified in args
+  // if not in args, use the one from --type
+  sat::Solvable::SplitIdent splid(parsedcap.detail().name());
+  if (splid.kind() != kind &&
+      zypper.cOpts().find("type") != zypper.cOpts().end())
+  {
+    // kind specified in arg, too - just warn and let it be
+    if (parsedcap.detail().name().asString().find(':') != string::npos)
+      zypper.out().warning(str::form(
+          _("Different package type specified in '%s' option and '%s'"
+            " argument. Will use the latter."),
+          "--type", arg.c_str()));
+    // no kind specified in arg, use --type
     else
-      // prepend the kind for non-packages if not already there (bnc #640399)
-      parsedcap = Capability::guessPackageSpec(
-          kind.asString() + ":" + arg, spec.modified);
+      parsedcap = Capability(
+          Arch(parsedcap.detail().arch()),
+          splid.name().asString(),
+          parsedcap.detail().op(),
+          parsedcap.detail().ed(),
+          kind);
+  }
 
-    if (spec.modified)
-    {
-      string msg = str::form(
-          _("'%s' not found in package names. Trying '%s'."),
-          arg.c_str(), parsedcap.asString().c_str());
-      zypper.out().info(msg,Out::HIGH); // TODO this should not be called here
-      DBG << "'" << arg << "' not found, trying '" << parsedcap <<  "'" << endl;
-    }
+  // recognize misplaced command line options given as packages (bnc#391644)
+  if (arg[0] == '-')
+  {
+    zypper.out().error(str::form(
+        _("'%s' is not a package name or capability."), arg.c_str()));
+    zypper.setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
+    ZYPP_THROW(ExitRequestException("cli option given after args"));
+  }
 
-    // set the right kind (bnc #580571)
-    // prefer those specified in args
-    // if not in args, use the one from --type
-    sat::Solvable::SplitIdent splid(parsedcap.detail().name());
-    if (splid.kind() != kind &&
-        zypper.cOpts().find("type") != zypper.cOpts().end())
-    {
-      // kind specified in arg, too - just warn and let it be
-      if (parsedcap.detail().name().asString().find(':') != string::npos)
-        zypper.out().warning(str::form(
-            _("Different package type specified in '%s' option and '%s'"
-              " argument. Will use the latter."),
-            "--type", arg.c_str()));
-      // no kind specified in arg, use --type
-      else
-        parsedcap = Capability(
-            Arch(parsedcap.detail().arch()),
-            splid.name().asString(),
-            parsedcap.detail().op(),
-            parsedcap.detail().ed(),
-            kind);
-    }
+  MIL << "got " << (dont?"un":"") << "wanted '" << parsedcap << "'";
+  MIL << "; repo '" << repo << "'" << endl;
 
-    // recognize misplaced command line options given as packages (bnc#391644)
-    if (arg[0] == '-')
-    {
-      zypper.out().error(str::form(
-          _("'%s' is not a package name or capability."), arg.c_str()));
-      zypper.setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
-      ZYPP_THROW(ExitRequestException("cli option given after args"));
-    }
+  // Store, but avoid duplicates in do and dont sets.
+  spec.parsed_cap = parsedcap;
+  spec.repo_alias = repo;
+  if (dont)
+  {
+    if (!remove_duplicate(_dos, spec))
+      _donts.insert(spec);
+  }
+  else if (!remove_duplicate(_donts, spec))
+    _dos.insert(spec);
+}
+
+// ---------------------------------------------------------------------------
+
+namespace
+{
+  inline size_t hashCap(const Capability & cap)
+  {
+    uint32_t hash = uint32_t(cap.id()) * 2654435761U;	// Knuth's multiplicative hash
+    return hash ^ (hash >> 16);
+  }
+} // namespace
+
+PackageSpecSet::size_type PackageSpecSet::slot(const Capability & cap) const
+{
+  size_type mask = _slots.size() - 1;
+  for (size_type pos = hashCap(cap) & mask; ; pos = (pos + 1) & mask)
+  {
+    unsigned idx = _slots[pos];
+    if (!idx || _specs[idx - 1].parsed_cap == cap)
+      return pos;
+  }
+}
+
+void PackageSpecSet::rehash(size_type slots)
+{
+  _slots.assign(slots, 0);
+  for (size_type idx = 0; idx < _specs.size(); ++idx)
+    _slots[slot(_specs[idx].parsed_cap)] = idx + 1;
+}
 
-    MIL << "got " << (dont?"un":"") << "wanted '" << parsedcap << "'";
-    MIL << "; repo '" << repo << "'" << endl;
+void PackageSpecSet::reserve(size_type count)
+{
+  _specs.reserve(count);
+  size_type slots = 16;
+  while (slots < 2 * count)	// keep the load factor <= 1/2
+    slots *= 2;
+  if (slots > _slots.size())
+    rehash(slots);
+}
+
+PackageSpecSet::const_iterator PackageSpecSet::find(const PackageSpec & spec) const
+{
+  if (_slots.empty())
+    return end();
+  unsigned idx = _slots[slot(spec.parsed_cap)];
+  return idx ? begin() + (idx - 1) : end();
+}
+
+pair<PackageSpecSet::const_iterator,bool> PackageSpecSet::insert(const PackageSpec & spec)
+{
+  if (2 * (_specs.size() + 1) > _slots.size())	// keep the load factor <= 1/2
+    rehash(_slots.empty() ? 16 : 2 * _slots.size());
+  unsigned & idx(_slots[slot(spec.parsed_cap)]);
+  if (idx)
+    return make_pair(begin() + (idx - 1), false);
+  _specs.push_back(spec);
+  idx = _specs.size();
+  return make_pair(end() - 1, true);
+}
 
-    // Store, but avoid duplicates in do and dont sets.
-    spec.parsed_cap = parsedcap;
-    spec.repo_alias = repo;
-    if (dont)
+void PackageSpecSet::erase(const_iterator it)
+{
+  size_type idx = it - begin();
+  size_type mask = _slots.size() - 1;
+
+  // free the slot, shifting back the following ones which would not be
+  // found anymore otherwise (no tombstones needed with linear probing)
+  size_type hole = slot(it->parsed_cap);
+  for (size_type pos = (hole + 1) & mask; _slots[pos]; pos = (pos + 1) & mask)
+  {
+    size_type home = hashCap(_specs[_slots[pos] - 1].parsed_cap) & mask;
+    if (((pos - home) & mask) >= ((pos - hole) & mask))
     {
-      if (!remove_duplicate(_dos, spec))
-        _donts.insert(spec);
+      _slots[hole] = _slots[pos];
+      hole = pos;
     }
-    else if (!remove_duplicate(_donts, spec))
-      _dos.insert(spec);
   }
+  _slots[hole] = 0;
+
+  // move the last spec into the gap
+  if (idx + 1 != _specs.size())
+  {
+    _slots[slot(_specs.back().parsed_cap)] = idx + 1;
+    _specs[idx] = std::move(_specs.back());
+  }
+  _specs.pop_back();
 }
 
+// ---------------------------------------------------------------------------
+
 std::ostream & operator<<(std::ostream & out, const PackageSpec & spec)
 {
   out << spec.orig_str << " cap:" << spec.parsed_cap;
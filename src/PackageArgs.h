@@ -13,11 +13,15 @@
 #define ZYPPER_PACKAGEARGS_H_
 
 #include <set>
+#include <deque>
 #include <vector>
+#include <unordered_map>
 #include <string>
 #include <utility>
 #include <iosfwd>
 
+#include <boost/utility/string_ref.hpp>
+
 #include <zypp/Capability.h>
 
 class Zypper;
@@ -33,22 +37,63 @@ struct PackageSpec
 };
 
 /**
- * Only comparing parsed capabilities. Even though repository may be different,
- * if capability is the same, we must rule out one of them.
+ * The specs of a \ref PackageArgs, unique by parsed capability only. Even
+ * though repository may be different, if capability is the same, we must
+ * rule out one of them.
+ *
+ * Specs are kept in a vector and iterated in insertion order (erase moves
+ * the last spec into the gap). They are looked up through an open addressing
+ * (linear probing) table of indexes into the vector, hashed by capability id.
+ * libsolv interns one id per kind, name, op, edition and arch, so no strings
+ * are compared.
  */
-struct PackageSpecCompare
+class PackageSpecSet
 {
-  bool operator()(const PackageSpec & lhs, const PackageSpec & rhs) const
-  {
-    return lhs.parsed_cap < rhs.parsed_cap;
-  };
+public:
+  typedef PackageSpec value_type;
+  typedef std::vector<PackageSpec>::size_type size_type;
+  typedef std::vector<PackageSpec>::const_iterator const_iterator;
+  typedef const_iterator iterator;
+
+public:
+  bool empty() const
+  { return _specs.empty(); }
+  size_type size() const
+  { return _specs.size(); }
+
+  const_iterator begin() const
+  { return _specs.begin(); }
+  const_iterator end() const
+  { return _specs.end(); }
+
+  /** The spec with the same capability as \a spec, or \ref end. */
+  const_iterator find(const PackageSpec & spec) const;
+
+  /** Insert \a spec unless there is one with the same capability already.
+   * Returns the spec in the set and whether it was inserted. */
+  std::pair<const_iterator,bool> insert(const PackageSpec & spec);
+
+  /** Erase the spec at \a it. Invalidates iterators to the last spec. */
+  void erase(const_iterator it);
+
+  /** Make room for \a count specs. */
+  void reserve(size_type count);
+
+private:
+  /** The slot holding \a cap, or the empty slot where it belongs. */
+  size_type slot(const zypp::Capability & cap) const;
+  void rehash(size_type slots);
+
+private:
+  std::vector<PackageSpec> _specs;
+  std::vector<unsigned> _slots;	///< index into _specs + 1, 0 if empty; size is a power of 2
 };
 
 class PackageArgs
 {
 public:
   typedef std::set<std::string> StringSet;
-  typedef std::set<PackageSpec, PackageSpecCompare> PackageSpecSet;
+  typedef ::PackageSpecSet PackageSpecSet;
 
   struct Options
   {
@@ -73,11 +118,20 @@ public:
       const zypp::ResKind & kind = zypp::ResKind::package,
       const Options & opts = Options());
 
+  /** Processes current Zypper::arguments() plus the specs read from
+   * \a manifest (see \ref readManifest). */
+  PackageArgs(
+      std::istream & manifest,
+      const zypp::ResKind & kind = zypp::ResKind::package,
+      const Options & opts = Options());
+
   ~PackageArgs() {}
 
   const Options & options() const
   {return _opts; }
 
+  /** The compiled command line arguments (specs read from a manifest
+   * are not included). */
   const StringSet & asStringSet() const
   { return _args; }
   /** Capabilities we want to install/upgrade and don't want to remove, plus
@@ -95,6 +149,18 @@ protected:
   /** join arguments at comparison operators ('=', '>=', and the like) */
   void preprocess(const std::vector<std::string> & args);
   void argsToCaps(const zypp::ResKind & kind);
+  /**
+   * Read specs from \a manifest and append those not yet in \a specs to
+   * \a specs. Specs are separated by whitespace like on the command line
+   * (operators may stand alone: 'name >= 1.0'), but are not joined across
+   * lines. Empty lines and lines starting with '#' are ignored.
+   * The appended views point into \a manifest, or into \a joined for
+   * specs joined at operators.
+   */
+  void readManifest(boost::string_ref manifest,
+      std::vector<boost::string_ref> & specs, std::deque<std::string> & joined);
+  /** Parse a single compiled argument and sort it into dos/donts. */
+  void argToCaps(boost::string_ref arg, const zypp::ResKind & kind);
 
 private:
   PackageArgs();
@@ -104,6 +170,8 @@ private:
   StringSet _args;
   PackageSpecSet _dos;
   PackageSpecSet _donts;
+  /** match_repo() results, a manifest tends to name the same repos often */
+  std::unordered_map<std::string,bool> _repoMatches;
 };
 
 
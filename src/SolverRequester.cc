@@ -15,6 +15,7 @@
 
 #include <zypp/PoolQuery.h>
 #include <zypp/PoolItemBest.h>
+#include <zypp/ResPoolProxy.h>
 
 #include <zypp/Capability.h>
 #include <zypp/Resolver.h>
@@ -91,8 +92,11 @@ void SolverRequester::installRemove(const PackageArgs & args)
   if (args.empty())
     return;
 
-  for_(it, args.dos().begin(), args.dos().end())
-    install(*it);
+  if (_command == ZypperCommand::INSTALL)
+    installBatch(args.dos());
+  else
+    for_(it, args.dos().begin(), args.dos().end())
+      install(*it);
 
   // TODO solve before processing dontCaps? so that we could unset any
   // dontCaps that are already set for installation. This would allow
@@ -142,84 +146,179 @@ void SolverRequester::install(const PackageSpec & pkg)
     // get the best matching items and tag them for installation.
     // FIXME this ignores vendor lock - we need some way to do --from which
     // would respect vendor lock: e.g. a new Selectable::updateCandidateObj(Options&)
-    PoolItemBest bestMatches(q.begin(), q.end());
-    if (!bestMatches.empty())
+    if (installByName(pkg, PoolItemBest(q.begin(), q.end())))
+      return;
+  }
+
+  installByCap(pkg);
+}
+
+// ----------------------------------------------------------------------------
+
+namespace
+{
+  /** Whether \a pkg_r can be looked up by name, without a PoolQuery. */
+  inline bool isPlainName(const PackageSpec & pkg_r)
+  {
+    const CapDetail & detail(pkg_r.parsed_cap.detail());
+    return detail.isNamed()
+        && detail.name().asString().find_first_of("*?[") == string::npos;
+  }
+}
+
+/*
+ * Like install(const PackageSpec&) for each of \a specs, but plain names
+ * (no glob, no version) are looked up in the pool proxy's selectable index,
+ * a hash lookup, instead of running a PoolQuery (i.e. a pool scan) each.
+ * Globs, capabilities, versioned specs and names not found that way (the
+ * PoolQuery matches names case insensitive) take the PoolQuery path.
+ */
+void SolverRequester::installBatch(const PackageArgs::PackageSpecSet & specs)
+{
+  if (_opts.force_by_cap)
+  {
+    for_(it, specs.begin(), specs.end())
+      install(*it);
+    return;
+  }
+
+  ResPoolProxy proxy(ResPool::instance().proxy());
+  set<string> repos(_opts.from_repos.begin(), _opts.from_repos.end());
+  vector<PoolItem> matches;
+  unsigned byName = 0;
+
+  for_(it, specs.begin(), specs.end())
+  {
+    const PackageSpec & pkg(*it);
+    Selectable::Ptr s;
+    if (isPlainName(pkg))
+    {
+      sat::Solvable::SplitIdent splid(pkg.parsed_cap.detail().name());
+      s = proxy.lookup(splid.kind(), splid.name().asString());
+    }
+    if (!s)
     {
-      unsigned notInstalled = 0;
-      for_(sit, bestMatches.begin(), bestMatches.end())
+      install(pkg);
+      continue;
+    }
+
+    // the items the PoolQuery would find (in --from repos or the spec's repo), in pool order
+    const CapDetail & detail(pkg.parsed_cap.detail());
+    Arch arch(detail.arch());
+    bool anyRepo = repos.empty() && pkg.repo_alias.empty();
+    matches.clear();
+    auto addMatch = [&](const PoolItem & pi_r)
+    {
+      sat::Solvable solv(pi_r.satSolvable());
+      string alias(solv.repository().alias());
+      if ((anyRepo || repos.count(alias) || alias == pkg.repo_alias)
+          && (!detail.hasArch() || solv.arch() == arch))
+        matches.push_back(pi_r);
+    };
+    for_(pit, s->installedBegin(), s->installedEnd())
+      addMatch(*pit);
+    for_(pit, s->availableBegin(), s->availableEnd())
+      addMatch(*pit);
+    if (matches.empty())
+    {
+      install(pkg);	// maybe a case insensitive match in the repos
+      continue;
+    }
+    ++byName;
+    sort(matches.begin(), matches.end(),
+         [](const PoolItem & lhs, const PoolItem & rhs)->bool
+         { return lhs.satSolvable().id() < rhs.satSolvable().id(); });
+
+    if (!installByName(pkg, PoolItemBest(matches.begin(), matches.end())))
+      installByCap(pkg);
+  }
+  MIL << byName << " of " << specs.size() << " install requests resolved by name lookup" << endl;
+}
+
+// ----------------------------------------------------------------------------
+
+bool SolverRequester::installByName(const PackageSpec & pkg, const PoolItemBest & bestMatches)
+{
+  if (!bestMatches.empty())
+  {
+    unsigned notInstalled = 0;
+    for_(sit, bestMatches.begin(), bestMatches.end())
+    {
+      Selectable::Ptr s(asSelectable()(*sit));
+      if (s->kind() == ResKind::patch)
+        installPatch(pkg, *sit);
+      else
       {
-        Selectable::Ptr s(asSelectable()(*sit));
-        if (s->kind() == ResKind::patch)
-          installPatch(pkg, *sit);
-        else
+        PoolItem instobj = get_installed_obj(s);
+        if (instobj)
         {
-          PoolItem instobj = get_installed_obj(s);
-          if (instobj)
-          {
-            if (s->availableEmpty())
-            {
-              if (!_opts.force)
-                addFeedback(Feedback::ALREADY_INSTALLED, pkg, instobj, instobj);
-              addFeedback(Feedback::NOT_IN_REPOS, pkg, instobj, instobj);
-              MIL << s->name() << " not in repos, can't (re)install" << endl;
-              return;
-            }
-
-            // whether user requested specific repo/version/arch
-            bool userconstraints =
-                pkg.parsed_cap.detail().isVersioned()
-                || pkg.parsed_cap.detail().hasArch()
-                || !_opts.from_repos.empty()
-                || !pkg.repo_alias.empty();
-
-            // check vendor (since PoolItemBest does not do it)
-            bool changes_vendor = ! VendorAttr::instance().equivalent(
-                instobj->vendor(), (*sit)->vendor());
-
-            PoolItem best;
-            if (userconstraints)
-              updateTo(pkg, *sit);
-            else if (_opts.force)
-              updateTo(pkg, s->highestAvailableVersionObj());
-            else if ((best = s->updateCandidateObj()))
-              updateTo(pkg, best);
-            else if (changes_vendor && !_opts.allow_vendor_change)
-              updateTo(pkg, instobj);
-            else
-              updateTo(pkg, *sit);
-          }
-          else if (_command == ZypperCommand::INSTALL)
+          if (s->availableEmpty())
           {
-            setToInstall(*sit);
-            MIL << "installing " << *sit << endl;
+            if (!_opts.force)
+              addFeedback(Feedback::ALREADY_INSTALLED, pkg, instobj, instobj);
+            addFeedback(Feedback::NOT_IN_REPOS, pkg, instobj, instobj);
+            MIL << s->name() << " not in repos, can't (re)install" << endl;
+            return true;
           }
+
+          // whether user requested specific repo/version/arch
+          bool userconstraints =
+              pkg.parsed_cap.detail().isVersioned()
+              || pkg.parsed_cap.detail().hasArch()
+              || !_opts.from_repos.empty()
+              || !pkg.repo_alias.empty();
+
+          // check vendor (since PoolItemBest does not do it)
+          bool changes_vendor = ! VendorAttr::instance().equivalent(
+              instobj->vendor(), (*sit)->vendor());
+
+          PoolItem best;
+          if (userconstraints)
+            updateTo(pkg, *sit);
+          else if (_opts.force)
+            updateTo(pkg, s->highestAvailableVersionObj());
+          else if ((best = s->updateCandidateObj()))
+            updateTo(pkg, best);
+          else if (changes_vendor && !_opts.allow_vendor_change)
+            updateTo(pkg, instobj);
           else
-	  {
-	    ++notInstalled;
-            // addFeedback(Feedback::NOT_INSTALLED, pkg);
-	    // delay Feedback::NOT_INSTALLED until we know
-	    // there is not a single match installed.
-	  }
+            updateTo(pkg, *sit);
+        }
+        else if (_command == ZypperCommand::INSTALL)
+        {
+          setToInstall(*sit);
+          MIL << "installing " << *sit << endl;
+        }
+        else
+        {
+          ++notInstalled;
+          // addFeedback(Feedback::NOT_INSTALLED, pkg);
+          // delay Feedback::NOT_INSTALLED until we know
+          // there is not a single match installed.
         }
       }
-      if ( notInstalled == bestMatches.size() )
-      {
-	addFeedback(Feedback::NOT_INSTALLED, pkg);
-      }
-      return;
     }
-    else if (_opts.force_by_name || pkg.modified)
+    if ( notInstalled == bestMatches.size() )
     {
-      addFeedback(Feedback::NOT_FOUND_NAME, pkg);
-      WAR << pkg << " not found" << endl;
-      return;
+      addFeedback(Feedback::NOT_INSTALLED, pkg);
     }
-
-    addFeedback(Feedback::NOT_FOUND_NAME_TRYING_CAPS, pkg);
+    return true;
+  }
+  else if (_opts.force_by_name || pkg.modified)
+  {
+    addFeedback(Feedback::NOT_FOUND_NAME, pkg);
+    WAR << pkg << " not found" << endl;
+    return true;
   }
 
-  // try by capability
+  addFeedback(Feedback::NOT_FOUND_NAME_TRYING_CAPS, pkg);
+  return false;
+}
+
+// ----------------------------------------------------------------------------
 
+void SolverRequester::installByCap(const PackageSpec & pkg)
+{
   // is there a provider for the requested capability?
   sat::WhatProvides q(pkg.parsed_cap);
   if (q.empty())
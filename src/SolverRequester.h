@@ -18,6 +18,7 @@
 #include <zypp/ZConfig.h>
 #include <zypp/Date.h>
 #include <zypp/PoolItem.h>
+#include <zypp/PoolItemBest.h>
 
 #include "Zypper.h"
 #include "PackageArgs.h"
@@ -386,6 +387,23 @@ private:
    */
   void install(const PackageSpec & pkg);
 
+  /**
+   * Like \ref install(const PackageSpec&) for each of \a specs, but plain
+   * names are looked up in the selectable index instead of running a
+   * PoolQuery for each of them. Results and feedback are the same.
+   */
+  void installBatch(const PackageArgs::PackageSpecSet & specs);
+
+  /**
+   * The 'by name' part of \ref install(const PackageSpec&): request the
+   * \a bestMatches found for \a pkg.
+   * \return \c false if nothing was found and \ref installByCap should be tried.
+   */
+  bool installByName(const PackageSpec & pkg, const zypp::PoolItemBest & bestMatches);
+
+  /** The 'by capability' part of \ref install(const PackageSpec&). */
+  void installByCap(const PackageSpec & pkg);
+
   /**
    * Request removal of all packages matching given \a cap by name/edition/arch,
    * or providing the capability.
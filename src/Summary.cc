@@ -8,6 +8,8 @@
 #include <string.h>
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <unordered_map>
 #include <boost/format.hpp>
 
 #include <zypp/ZYppFactory.h>
@@ -24,6 +26,7 @@
 #include "utils/colors.h"
 #include "utils/misc.h"
 #include "Table.h"
+#include "output/OutJSON.h"
 #include "Zypper.h"
 
 #include "Summary.h"
@@ -101,7 +104,7 @@ void Summary::readPool(const zypp::ResPool & pool)
   MIL << "Pool contains " << pool.size() << " items." << std::endl;
   DBG << "Install summary:" << endl;
 
-  debug::Measure m;
+  debug::Measure m( "Summary::readPool" );
 
   for (ResPool::const_iterator it = pool.begin(); it != pool.end(); ++it)
   {
@@ -146,6 +149,17 @@ void Summary::readPool(const zypp::ResPool & pool)
 
   m.elapsed();
 
+  // index to_be_removed by name (in set order), so finding the removal
+  // matching an install is a lookup instead of a scan of the whole kind
+  typedef std::unordered_map<std::string, std::vector<ResObject::constPtr> > NameToResObjects;
+  std::map<ResKind, NameToResObjects> removed_by_name;
+  for_(it, to_be_removed.begin(), to_be_removed.end())
+  {
+    NameToResObjects & byname(removed_by_name[it->first]);
+    for_(resit, it->second.begin(), it->second.end())
+      byname[(*resit)->name()].push_back(*resit);
+  }
+
   // iterate the to_be_installed to find installs/upgrades/downgrades + size info
   for (KindToResObjectSet::const_iterator it = to_be_installed.begin();
       it != to_be_installed.end(); ++it)
@@ -166,8 +180,9 @@ void Summary::readPool(const zypp::ResPool & pool)
 
       // find in to_be_removed:
       bool upgrade_downgrade = false;
-      for (set<ResObject::constPtr>::iterator rmit = to_be_removed[res->kind()].begin();
-          rmit != to_be_removed[res->kind()].end(); ++rmit)
+      std::vector<ResObject::constPtr> & same_name(removed_by_name[res->kind()][res->name()]);
+      for (std::vector<ResObject::constPtr>::iterator rmit = same_name.begin();
+          rmit != same_name.end(); ++rmit)
       {
         if (res->name() == (*rmit)->name())
         {
@@ -216,6 +231,7 @@ void Summary::readPool(const zypp::ResPool & pool)
 
           // this turned out to be an upgrade/downgrade
           to_be_removed[res->kind()].erase(*rmit);
+          same_name.erase(rmit);
           upgrade_downgrade = true;
           break;
         }
@@ -1545,3 +1561,58 @@ void Summary::dumpAsXmlTo(ostream & out)
 
   out << "</install-summary>" << endl;
 }
+
+// --------------------------------------------------------------------------
+
+void Summary::writeJsonResolvableList(JsonLine & line, const char * key, const KindToResPairSet & resolvables)
+{
+  if (resolvables.empty())
+    return;
+
+  line.beginArray(key);
+  for_(it, resolvables.begin(), resolvables.end())
+  {
+    for_(pairit, it->second.begin(), it->second.end())
+    {
+      ResObject::constPtr res(pairit->second);
+      ResObject::constPtr rold(pairit->first);
+
+      line.beginObject()
+        .str("type", res->kind().asString())
+        .str("name", res->name())
+        .str("edition", res->edition().asString())
+        .str("arch", res->arch().asString());
+      if (rold)
+      {
+        line.str("edition-old", rold->edition().asString())
+          .str("arch-old", rold->arch().asString());
+      }
+      if (!res->summary().empty())
+        line.str("summary", res->summary());
+      if (!res->description().empty())
+        line.str("description", res->description());
+      line.endObject();
+    }
+  }
+  line.endArray();
+}
+
+void Summary::dumpAsJsonTo(ostream & out)
+{
+  std::string buffer;
+  JsonLine line(buffer, "install-summary");
+  line.num("download-size", (ByteCount::SizeType) _todownload);
+  line.num("space-usage-diff", (ByteCount::SizeType) _inst_size_change);
+
+  writeJsonResolvableList(line, "to-upgrade", _toupgrade);
+  writeJsonResolvableList(line, "to-downgrade", _todowngrade);
+  writeJsonResolvableList(line, "to-install", _toinstall);
+  writeJsonResolvableList(line, "to-reinstall", _toreinstall);
+  writeJsonResolvableList(line, "to-remove", _toremove);
+  writeJsonResolvableList(line, "to-change-arch", _tochangearch);
+  writeJsonResolvableList(line, "to-change-vendor", _tochangevendor);
+  if (_viewop & SHOW_UNSUPPORTED)
+    writeJsonResolvableList(line, "unsupported", _unsupported);
+
+  line.write(out, true);
+}
@@ -18,6 +18,7 @@
 #include <zypp/ResObject.h>
 #include <zypp/ResPool.h>
 
+class JsonLine;
 
 class Summary : private zypp::base::NonCopyable
 {
@@ -112,6 +113,8 @@ public:
 
   void dumpTo(std::ostream & out);
   void dumpAsXmlTo(std::ostream & out);
+  /** Write the summary as a single \c install-summary JSON line (see \ref OutJSON). */
+  void dumpAsJsonTo(std::ostream & out);
 
 private:
   void readPool(const zypp::ResPool & pool);
@@ -121,6 +124,7 @@ private:
   { return writeResolvableList( out, resolvables, ansi::Color::nocolor(), maxEntries_r, withKind_r ); }
 
   void writeXmlResolvableList(std::ostream & out, const KindToResPairSet & resolvables);
+  void writeJsonResolvableList(JsonLine & line, const char * key, const KindToResPairSet & resolvables);
 
   void collectInstalledRecommends(const zypp::ResObject::constPtr & obj);
 
@@ -1,10 +1,14 @@
 #include <iostream>
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
+#include <errno.h>
+#include <unistd.h>
 
 #include <zypp/base/LogTools.h>
 #include <zypp/base/String.h>
 #include <zypp/base/DtorReset.h>
+#include <zypp/Edition.h>
 
 #include "utils/colors.h"
 #include "utils/console.h"
@@ -39,10 +43,24 @@ const char * lines[][3] = {
 
 TableRow & TableRow::add( std::string s )
 {
+  if ( _widths.size() == _columns.size() )	// else recomputed on demand
+    _widths.push_back( mbs_width( s ) );
   _columns.push_back( std::move(s) );
   return *this;
 }
 
+unsigned TableRow::width( unsigned c ) const
+{
+  if ( _widths.size() != _columns.size() )
+  {
+    _widths.clear();
+    _widths.reserve( _columns.size() );
+    for ( const auto & col : _columns )
+      _widths.push_back( mbs_width( col ) );
+  }
+  return _widths[c];
+}
+
 TableRow & TableRow::addDetail( string s )
 {
   _details.push_back( std::move(s) );
@@ -128,16 +146,15 @@ std::ostream & TableRow::dumpTo( std::ostream & stream, const Table & parent ) c
 
     // stream.width (widths[c]); // that does not work with multibyte chars
     const string & s = *i;
-    ssize = mbs_width (s);
+    ssize = width (c);
     if (ssize > parent._max_width[c])
     {
       unsigned cutby = parent._max_width[c] - 2;
-      string cutstr = mbs_substr_by_width(s, 0, cutby);
-      stream << cutstr << string(cutby - mbs_width(cutstr), ' ') << "->";
+      // mbs_substr_by_width pads clipped multicolumn chars, so the result is exactly cutby wide
+      stream << mbs_substr_by_width(s, 0, cutby) << "->";
     }
     else
     {
-      string s(*i);
       if ( !parent._inHeader && parent.editionStyle( c ) && Zypper::instance()->config().do_colors )
       {
 	// Edition column
@@ -208,14 +225,51 @@ Table::Table()
   , _force_break_after(-1)
   , _do_wrap(false)
   , _inHeader( false )
+  , _stream( nullptr )
+  , _stream_sample( 0 )
+  , _streaming( false )
 {}
 
 Table & Table::add( TableRow tr )
 {
+  if ( _streaming )
+  {
+    // too late to align the previous rows, but don't cut this one
+    updateColWidths( tr );
+    tr.dumpTo( *_stream, *this );
+    return *this;
+  }
+
   _rows.push_back( std::move(tr) );
+  if ( _stream && _rows.size() >= _stream_sample )
+    startStreaming();
   return *this;
 }
 
+void Table::streamTo( std::ostream & stream, unsigned sample )
+{
+  _stream = &stream;
+  _stream_sample = sample ? sample : 1;
+  if ( _rows.size() >= _stream_sample )
+    startStreaming();
+}
+
+bool Table::autoStream( unsigned sample )
+{
+  if ( ::isatty( STDOUT_FILENO ) )
+    return false;
+  streamTo( cout, sample );
+  return true;
+}
+
+void Table::startStreaming()
+{
+  DBG << "Streaming table after " << _rows.size() << " rows" << endl;
+  dumpTo( *_stream );
+  _rows.clear();
+  _streaming = true;
+}
+
 Table & Table::setHeader( TableHeader tr )
 {
   _has_header = true;
@@ -246,11 +300,10 @@ void Table::updateColWidths (const TableRow& tr) const
     _max_col = _max_width.size()-1;
   }
 
-  unsigned c = 0;
-  for ( const auto & col : tr._columns )
+  for ( unsigned c = 0; c < tr._columns.size(); ++c )
   {
-    unsigned &max = _max_width[c++];
-    unsigned cur = mbs_width (col);
+    unsigned &max = _max_width[c];
+    unsigned cur = tr.width (c);
 
     if (max < cur)
       max = cur;
@@ -283,6 +336,10 @@ void Table::dumpRule (ostream &stream) const {
 
 std::ostream & Table::dumpTo( std::ostream & stream ) const
 {
+  // header and rows were already printed while streaming
+  if ( _streaming )
+    return stream;
+
   // compute column sizes
   if ( _has_header )
     updateColWidths( _header );
@@ -337,9 +394,133 @@ void Table::margin(unsigned margin) {
     ERR << "margin of " << margin << " is greater than half of the screen" << endl;
 }
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** A cells sort key, extracted once per row. */
+  struct SortKey
+  {
+    /** Also the order of keys of different type. */
+    enum Type { MISSING, NUMBER, EDITION, STRING };
+
+    SortKey()
+    : type( MISSING ), number( 0 ), str( nullptr )
+    {}
+
+    Type type;
+    long long number;
+    zypp::Edition edition;
+    const std::string * str;
+  };
+
+  SortKey sortKey( const TableRow & row_r, unsigned column_r, bool edition_r, bool numeric_r )
+  {
+    SortKey ret;
+    if ( column_r >= row_r.columns().size() )
+      return ret;
+
+    const std::string & cell( row_r.columns()[column_r] );
+    ret.type = SortKey::STRING;
+    ret.str = &cell;
+
+    if ( edition_r )
+    {
+      ret.type = SortKey::EDITION;
+      ret.edition = zypp::Edition( cell );
+    }
+    else if ( numeric_r )
+    {
+      // skip padding and color sequences
+      const char * p = cell.c_str();
+      for ( ; *p; ++p )
+      {
+	if ( *p == '\033' )
+	{
+	  const char * e = ::strchr( p, 'm' );
+	  if ( ! e )
+	    break;
+	  p = e;
+	}
+	else if ( *p != ' ' )
+	  break;
+      }
+      char * end = nullptr;
+      errno = 0;
+      long long num = ::strtoll( p, &end, 10 );
+      if ( end != p && errno == 0 )
+      {
+	ret.type = SortKey::NUMBER;
+	ret.number = num;
+      }
+    }
+    return ret;
+  }
+
+  inline int compare( const SortKey & lhs, const SortKey & rhs )
+  {
+    if ( lhs.type != rhs.type )
+      return lhs.type < rhs.type ? -1 : 1;
+
+    switch ( lhs.type )
+    {
+      case SortKey::MISSING:
+	return 0;
+      case SortKey::NUMBER:
+	return lhs.number < rhs.number ? -1 : ( lhs.number > rhs.number ? 1 : 0 );
+      case SortKey::EDITION:
+	return lhs.edition.compare( rhs.edition );
+      case SortKey::STRING:
+	break;
+    }
+    return lhs.str->compare( *rhs.str );
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
 void Table::sort (unsigned by_column) {
-  TableRow::Less comp(by_column);
-  _rows.sort( comp );
+  sort( vector<unsigned>( 1, by_column ) );
+}
+
+void Table::sort( const vector<unsigned> & by_columns )
+{
+  if ( by_columns.empty() || _rows.size() < 2 )
+    return;
+
+  // Extract the keys once, so comparing does not parse editions
+  // or numbers over and over again.
+  vector<vector<SortKey>> keys( by_columns.size() );
+  for ( unsigned k = 0; k < by_columns.size(); ++k )
+  {
+    unsigned column = by_columns[k];
+    bool edition = editionStyle( column );
+    bool numeric = numericStyle( column );
+    keys[k].reserve( _rows.size() );
+    for ( const TableRow & row : _rows )
+      keys[k].push_back( sortKey( row, column, edition, numeric ) );
+  }
+
+  // Sort indices rather than the rows, then move each row into place once.
+  vector<unsigned> index( _rows.size() );
+  for ( unsigned i = 0; i < index.size(); ++i )
+    index[i] = i;
+
+  std::stable_sort( index.begin(), index.end(),
+		    [&keys]( unsigned lhs, unsigned rhs )->bool
+		    {
+		      for ( const auto & key : keys )
+		      {
+			int diff = compare( key[lhs], key[rhs] );
+			if ( diff )
+			  return diff < 0;
+		      }
+		      return false;
+		    } );
+
+  container sorted;
+  sorted.reserve( _rows.size() );
+  for ( unsigned i : index )
+    sorted.push_back( std::move(_rows[i]) );
+  _rows.swap( sorted );
 }
 
 // Local Variables:
@@ -56,7 +56,7 @@ private:
 public:
   //! Constructor. Reserve place for c columns.
   TableRow( unsigned c = 0U )
-  { _columns.reserve (c); }
+  { _columns.reserve (c); _widths.reserve (c); }
 
 
   TableRow & add( std::string s );
@@ -88,30 +88,20 @@ public:
 
   typedef vector<string> container;
 
-  // BinaryPredicate
-  struct Less
-  {
-    unsigned _by_column;
-    Less (unsigned by_column): _by_column (by_column) {}
-
-    bool operator()( const TableRow & a, const TableRow & b ) const
-    {
-      bool noL = _by_column >= a._columns.size();
-      bool noR = _by_column >= b._columns.size();
-      if ( noL || noR )
-      {	return noL && ! noR; }
-      return a._columns[_by_column] < b._columns[_by_column];
-    }
-  };
-
   const container & columns() const
   { return _columns; }
 
+  //! \note The cached column widths are recomputed after modifying the columns.
   container & columns()
-  { return _columns; }
+  { _widths.clear(); return _columns; }
+
+  //! display width of column \a c (cached)
+  unsigned width( unsigned c ) const;
 
 private:
   container _columns;
+  //! mbs_width of the columns, computed when added
+  mutable vector<unsigned> _widths;
   container _details;
   friend class Table;
 };
@@ -145,7 +135,7 @@ TableHeader && operator<<( TableHeader && th, Tp_ && val )
 /** \todo nice idea but poor interface */
 class Table {
 public:
-  typedef list<TableRow> container;
+  typedef vector<TableRow> container;
 
   static TableLineStyle defaultStyle;
 
@@ -155,8 +145,39 @@ public:
 
 
   std::ostream & dumpTo( std::ostream & stream ) const;
-  bool empty () const { return _rows.empty(); }
+  bool empty () const { return _rows.empty() && ! _streaming; }
   void sort (unsigned by_column);       // columns start with 0...
+  /** Sort by the first of \a by_columns, rows comparing equal by the
+   * next one, and so on. The sort is stable.
+   *
+   * Rows lacking a column sort first. Edition style columns are compared
+   * as \ref zypp::Edition, numeric style columns as numbers (non-numbers
+   * after numbers), others as plain strings.
+   */
+  void sort( const vector<unsigned> & by_columns );
+
+  /** Reserve space for \a rows rows (e.g. if the result size is known). */
+  void reserve( unsigned rows )
+  { _rows.reserve( rows ); }
+
+  /** Print rows to \a stream as they are added, instead of buffering
+   * the whole table.
+   *
+   * The first \a sample rows are buffered to compute the column widths.
+   * Then the header and the buffered rows are printed, and any further row
+   * is printed immediately (widening its columns if necessary, but never
+   * truncating them). Rows must therefore be added in their final order,
+   * and the header must be set before.
+   *
+   * If the table has less than \a sample rows, \ref dumpTo prints it
+   * as usual.
+   */
+  void streamTo( std::ostream & stream, unsigned sample = 1000 );
+
+  /** \ref streamTo \c cout if stdout is not a terminal.
+   * \return whether the table is streamed.
+   */
+  bool autoStream( unsigned sample = 1000 );
 
   void lineStyle (TableLineStyle st);
   void wrap(int force_break_after = -1);
@@ -176,9 +197,14 @@ public:
   void setEditionStyle( unsigned column )
   { _editionStyle.insert( column ); }
 
+  //! sort \a column by number (e.g. IDs or priorities)
+  void setNumericStyle( unsigned column )
+  { _numericStyle.insert( column ); }
+
 private:
   void dumpRule (ostream &stream) const;
   void updateColWidths (const TableRow& tr) const;
+  void startStreaming();
 
   bool _has_header;
   TableHeader _header;
@@ -205,9 +231,18 @@ private:
   bool _do_wrap;
 
   mutable bool _inHeader;
+  //! stream rows to, if not NULL
+  std::ostream * _stream;
+  //! number of rows to buffer before streaming
+  unsigned _stream_sample;
+  //! whether the header and the sampled rows were printed
+  bool _streaming;
   std::set<unsigned> _editionStyle;
   bool editionStyle( unsigned column ) const
   { return _editionStyle.find( column ) != _editionStyle.end(); }
+  std::set<unsigned> _numericStyle;
+  bool numericStyle( unsigned column ) const
+  { return _numericStyle.find( column ) != _numericStyle.end(); }
 
   friend class TableRow;
 };
@@ -15,8 +15,14 @@
 #include <list>
 #include <map>
 #include <iterator>
+#include <vector>
+#include <algorithm>
+#include <memory>
 
+#include <cstring>
+#include <errno.h>
 #include <unistd.h>
+#include <sys/wait.h>
 #include <readline/history.h>
 
 #include <boost/logic/tribool.hpp>
@@ -62,9 +68,11 @@
 #include "source-download.h"
 #include "configtest.h"
 #include "subcommand.h"
+#include "shell-daemon.h"
 
 #include "output/OutNormal.h"
 #include "output/OutXML.h"
+#include "output/OutJSON.h"
 
 using boost::format;
 using namespace zypp;
@@ -215,7 +223,7 @@ Zypper::Zypper()
     _command(ZypperCommand::NONE),
     _exit_code(ZYPPER_EXIT_OK),
     _running_shell(false), _running_help(false), _exit_requested(false),
-    _sh_argc(0), _sh_argv(NULL)
+    _sh_argc(0), _sh_argv(NULL), _sh_daemon(false)
 {
   MIL << "Zypper instance created." << endl;
 }
@@ -265,7 +273,10 @@ int Zypper::main(int argc, char ** argv)
   switch(command().toEnum())
   {
   case ZypperCommand::SHELL_e:
-    commandShell();
+    if ( _sh_daemon )
+      commandShellDaemon();
+    else
+      commandShell();
     cleanup();
     return exitCode();
 
@@ -317,7 +328,10 @@ void print_main_help(Zypper & zypper)
     "\t\t\t\tDo not treat patches as interactive, which have\n"
     "\t\t\t\tthe rebootSuggested-flag set.\n"
     "\t--xmlout, -x\t\tSwitch to XML output.\n"
+    "\t--json\t\t\tSwitch to JSON output (one event per line).\n"
     "\t--ignore-unknown, -i\tIgnore unknown packages.\n"
+    "\t--client\t\tLet a running 'zypper shell --daemon' execute the\n"
+    "\t\t\t\tcommand, if it supports it (must be the first option).\n"
   );
 
   static string repo_manager_options = _(
@@ -557,6 +571,7 @@ void Zypper::processGlobalOptions()
     {"no-remote",                  no_argument,       0,  0 },
     {"releasever",                 required_argument, 0,  0 },
     {"xmlout",                     no_argument,       0, 'x'},
+    {"json",                       no_argument,       0,  0 },
     {"config",                     required_argument, 0, 'c'},
     {"userdata",                   required_argument, 0,  0 },
     {"ignore-unknown",             no_argument,       0, 'i'},
@@ -636,6 +651,14 @@ void Zypper::processGlobalOptions()
     _gopts.machine_readable = true;
     _gopts.no_abbrev = true;
   }
+  //// --json
+  else if (gopts.count("json"))
+  {
+    _config.do_colors = false;
+    _out_ptr = new OutJSON(verbosity);
+    _gopts.machine_readable = true;
+    _gopts.no_abbrev = true;
+  }
   else
   {
     OutNormal * p = new OutNormal(verbosity);
@@ -744,6 +767,8 @@ void Zypper::processGlobalOptions()
     std::string arg = _argv[optind++];
     if ( arg == "-h" || arg == "--help" )
       setRunningHelp(true);
+    else if ( arg == "--daemon" && optind == _argc )
+      _sh_daemon = true;
     else
     {
       report_too_many_arguments( "shell\n" );
@@ -1125,6 +1150,126 @@ void Zypper::commandShell()
   setRunningShell(false);
 }
 
+void Zypper::commandShellDaemon()
+{
+  MIL << "Entering the shell daemon" << endl;
+
+  setRunningShell(true);
+
+  if ( _gopts.changedRoot && _gopts.root_dir != "/" )
+  {
+    // bnc#575096: Quick fix
+    ::setenv( "ZYPP_LOCKFILE_ROOT", _gopts.root_dir.c_str(), 0 );
+  }
+
+  // We serve read-only commands only, so don't block others by
+  // holding the zypp lock. Also the daemon must not refresh anything.
+  zypp_readonly_hack::IWantIt();
+  _gopts.no_refresh = true;
+
+  bool reload = false;
+  try
+  {
+    God = zypp::getZYpp();
+    if ( defaultLoadSystem() != ZYPPER_EXIT_OK )
+      return;
+    std::string stamp( shell_daemon_stamp( _gopts.rm_options ) );
+
+    ShellDaemon daemon( shell_daemon_socket() );
+    out().info( boost::str(format(_("Listening on '%s'.")) % shell_daemon_socket()) );
+
+    ShellDaemon::Request request;
+    while ( ! exitRequested() && daemon.accept( request ) )
+    {
+      ZypperCommand command( ZypperCommand::NONE );
+      try { if ( ! request.args.empty() ) command = ZypperCommand( request.args[0] ); }
+      catch ( const Exception & e ) { ZYPP_CAUGHT( e ); }
+
+      if ( ! shell_daemon_serves( command ) )
+      {
+        DBG << "Refuse to serve: " << request.args << endl;
+        daemon.reply( request, -1 );
+        continue;
+      }
+
+      // init_repos() and load_resolvables() were done for all repos
+      // and won't run again, so we can't restrict them per request
+      if ( shell_daemon_selects_repos( command, request.args ) )
+      {
+        DBG << "Refuse to serve repo specific request: " << request.args << endl;
+        daemon.reply( request, -1 );
+        continue;
+      }
+
+      if ( shell_daemon_stamp( _gopts.rm_options ) != stamp )
+      {
+        // rpmdb or repo caches changed: let the client do it and restart
+        MIL << "Pool is outdated. Reloading..." << endl;
+        daemon.reply( request, -1 );
+        reload = true;
+        break;
+      }
+
+      // Each command runs in a forked child, so the pool and the
+      // daemons state are not affected by the command.
+      MIL << "Serving: " << request.args << endl;
+      std::cout.flush();
+      std::cerr.flush();
+      pid_t pid = ::fork();
+      if ( pid == 0 )
+      {
+        for ( int fd = 0; fd < 3; ++fd )
+          ::dup2( request.fd[fd], fd );
+
+        std::vector<char *> argv;
+        for ( std::string & arg : request.args )
+          argv.push_back( &arg[0] );
+        argv.push_back( nullptr );
+
+        optind = 0;
+        _sh_argc = request.args.size();
+        _sh_argv = argv.data();
+        setCommand( command );
+        safeDoCommand();
+
+        std::cout.flush();
+        std::cerr.flush();
+        ::_exit( exitCode() );
+      }
+
+      int status = 0;
+      int code = ZYPPER_EXIT_ERR_BUG;
+      if ( pid > 0 )
+      {
+        while ( ::waitpid( pid, &status, 0 ) < 0 && errno == EINTR )
+        {;} // just loop
+        if ( WIFEXITED(status) )
+          code = WEXITSTATUS(status);
+      }
+      else
+        ERR << "fork failed: " << ::strerror( errno ) << endl;
+      daemon.reply( request, code );
+    }
+  }
+  catch ( const Exception & e )
+  {
+    ZYPP_CAUGHT( e );
+    out().error( e.asUserString() );
+    setExitCode( ZYPPER_EXIT_ERR_ZYPP );
+  }
+
+  MIL << "Leaving the shell daemon" << endl;
+  setRunningShell(false);
+
+  if ( reload )
+  {
+    cleanup();
+    ::execv( "/proc/self/exe", _argv );
+    ERR << "Can't restart: " << ::strerror( errno ) << endl;
+    setExitCode( ZYPPER_EXIT_ERR_BUG );
+  }
+}
+
 void Zypper::shellCleanup()
 {
   MIL << "Cleaning up for the next command." << endl;
@@ -1285,6 +1430,7 @@ void Zypper::processCommandOptions()
       // rug compatibility option, we have --repo
       {"catalog",                   required_argument, 0, 'c'},
       {"from",                      required_argument, 0,  0 },
+      {"from-file",                 required_argument, 0,  0 },
       {"type",                      required_argument, 0, 't'},
       // the default (ignored)
       {"name",                      no_argument,       0, 'n'},
@@ -1330,6 +1476,9 @@ void Zypper::processCommandOptions()
       "\n"
       "  Command options:\n"
       "    --from <alias|#|URI>    Select packages from the specified repository.\n"
+      "    --from-file <file>      Read additional capabilities from <file>, separated\n"
+      "                            by whitespace or newlines ('-' reads them from\n"
+      "                            standard input, requires --non-interactive).\n"
       "-r, --repo <alias|#|URI>    Load only the specified repository.\n"
       "-t, --type <type>           Type of package (%s).\n"
       "                            Default: %s.\n"
@@ -1872,6 +2021,7 @@ void Zypper::processCommandOptions()
       {"download-only", no_argument, 0, 'D'},
       {"repo", required_argument, 0, 'r'},
       {"services", no_argument, 0, 's'},
+      {"parallel", required_argument, 0, 0},
       {"help", no_argument, 0, 'h'},
       {0, 0, 0, 0}
     };
@@ -1890,6 +2040,7 @@ void Zypper::processCommandOptions()
       "-D, --download-only      Only download raw metadata, don't build the database.\n"
       "-r, --repo <alias|#|URI> Refresh only specified repositories.\n"
       "-s, --services           Refresh also services before refreshing repos.\n"
+      "    --parallel <N>       Download the metadata of up to N repos at once.\n"
     );
     break;
   }
@@ -2754,6 +2905,7 @@ void Zypper::processCommandOptions()
       {"help",		no_argument,		0, 'h'},
       {"short",		no_argument,		0, 's'},
       {"print",		required_argument,	0,  0 },
+      {"changed-since-commit",	no_argument,	0,  0 },
       {0, 0, 0, 0}
     };
     specific_options = options;
@@ -2769,6 +2921,8 @@ void Zypper::processCommandOptions()
 	     _("Create a short table not showing the deleted files. Given twice, show only processes which are associated with a system service. Given three times, list the associated system service names only.") )
     .option( "--print <format>",	// translators: --print <format>
 	     _("For each associated system service print <format> on the standard output, followed by a newline. Any '%s' directive in <format> is replaced by the the system service name.") )
+    .option( "--changed-since-commit",	// translators: --changed-since-commit
+	     _("Check only for files removed or replaced by the last commit, instead of all deleted files.") )
     ;
     break;
   }
@@ -2783,6 +2937,8 @@ void Zypper::processCommandOptions()
       {"help",			no_argument,		0, 'h'},
       {"all-matches",		no_argument,		&myOpts->_allmatches, 1},
       {"dry-run",		no_argument,		&myOpts->_dryrun, 1},
+      {"parallel",		required_argument,	0, 0},
+      {"max-per-repo",		required_argument,	0, 0},
       {0, 0, 0, 0}
     };
     specific_options = options;
@@ -2804,6 +2960,9 @@ void Zypper::processCommandOptions()
       "                     each matching package is downloaded.\n"
       "--dry-run            Don't download any package, just report what\n"
       "                     would be done.\n"
+      "--parallel <N>       Download up to N packages at once.\n"
+      "--max-per-repo <N>   Download at most N packages at once from the\n"
+      "                     same repository.\n"
     );
     break;
   }
@@ -2822,6 +2981,7 @@ void Zypper::processCommandOptions()
       {"delete",		no_argument, &myOpts->_delete, 1},
       {"no-delete",		no_argument, &myOpts->_delete, 0},
       {"status",		no_argument, &myOpts->_dryrun, 1},
+      {"parallel",		required_argument, 0, 0},
       {0, 0, 0, 0}
     };
     specific_options = options;
@@ -2838,6 +2998,7 @@ void Zypper::processCommandOptions()
       "--no-delete          Do not delete extraneous source rpms.\n"
       "--status             Don't download any source rpms,\n"
       "                     but show which source rpms are missing or extraneous.\n"
+      "--parallel <N>       Download up to N source rpms at once.\n"
     );
 //       "--manifest           Write MANIFEST of packages and coresponding source rpms.\n"
 //       "--no-manifest        Do not write MANIFEST.\n"
@@ -2866,15 +3027,18 @@ void Zypper::processCommandOptions()
   {
     static struct option quit_options[] = {
       {"help", no_argument, 0, 'h'},
+      {"daemon", no_argument, 0, 0},
       {0, 0, 0, 0}
     };
     specific_options = quit_options;
     _command_help = _(
-      "shell (sh)\n"
+      "shell (sh) [--daemon]\n"
       "\n"
       "Enter the zypper command shell.\n"
       "\n"
-      "This command has no additional options.\n"
+      "  Command options:\n"
+      "    --daemon    Load the pool once and serve read-only commands\n"
+      "                of 'zypper --client' on a local socket.\n"
     );
     break;
   }
@@ -3829,7 +3993,7 @@ void Zypper::doCommand()
   {
     if (runningHelp()) { out().info(_command_help, Out::QUIET); return; }
 
-    if (_arguments.size() < 1 && !_copts.count("entire-catalog"))
+    if (_arguments.size() < 1 && !_copts.count("entire-catalog") && !_copts.count("from-file"))
     {
       out().error(
           _("Too few arguments."),
@@ -3839,6 +4003,18 @@ void Zypper::doCommand()
       return;
     }
 
+    // a manifest read from stdin leaves nothing to answer the prompts with
+    if (_copts.count("from-file") && _copts["from-file"].front() == "-"
+        && !globalOpts().non_interactive)
+    {
+      out().error(
+          str::form(_("Reading '%s' from standard input requires the global option %s."),
+                    "--from-file", "--non-interactive"),
+          _("Prompts would read their answers from the same input."));
+      setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
+      return;
+    }
+
     // check root user
     if (geteuid() != 0 && !globalOpts().changedRoot)
     {
@@ -3987,7 +4163,7 @@ void Zypper::doCommand()
       refresh_repo(*this, repo);
     }
     // no rpms and no other arguments either
-    else if (_arguments.empty())
+    else if (_arguments.empty() && !_copts.count("from-file"))
     {
       out().error(_("No valid arguments specified."));
       setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
@@ -4024,7 +4200,28 @@ void Zypper::doCommand()
     PackageArgs::Options argopts;
     if (!install_not_remove)
       argopts.do_by_default = false;
-    PackageArgs args(kind, argopts);
+    std::unique_ptr<PackageArgs> argsptr;
+    if ((optit = copts.find("from-file")) != copts.end())
+    {
+      // a manifest: too many specs for the command line (ARG_MAX)
+      const string & manifest(optit->second.front());
+      if (manifest == "-")
+        argsptr.reset(new PackageArgs(cin, kind, argopts));
+      else
+      {
+        ifstream in(manifest.c_str());
+        if (!in)
+        {
+          out().error(str::form(_("Cannot read file '%s'."), manifest.c_str()));
+          setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
+          return;
+        }
+        argsptr.reset(new PackageArgs(in, kind, argopts));
+      }
+    }
+    else
+      argsptr.reset(new PackageArgs(kind, argopts));
+    const PackageArgs & args(*argsptr);
 
     // tell the solver what we want
 
@@ -4220,12 +4417,13 @@ void Zypper::doCommand()
     if (exitCode() != ZYPPER_EXIT_OK)
       return;
 
-    // add available repos to query
+    // available repos to search; added to the query last (see parallelQuery)
+    std::set<std::string> searchRepos;
     if (cOpts().count("repo"))
     {
       std::list<zypp::RepoInfo>::const_iterator repo_it;
       for (repo_it = _rdata.repos.begin();repo_it != _rdata.repos.end();++repo_it){
-        query.addRepo( repo_it->alias());
+        searchRepos.insert( repo_it->alias());
         if (! repo_it->enabled())
         {
           out().warning(boost::str(format(
@@ -4236,6 +4434,26 @@ void Zypper::doCommand()
     }
 
     bool details = _copts.count("details") || _copts.count("verbose");
+    std::vector<std::string> searchTexts;
+    std::vector<std::string> searchFiles;
+    // whether the query has attributes besides searchTexts and searchFiles
+    bool queryAttributes = ! copts.count("file-list")
+                        || copts.count("name") || copts.count("provides") || copts.count("requires")
+                        || copts.count("recommends") || copts.count("suggests")
+                        || copts.count("conflicts") || copts.count("obsoletes");
+    // file list searches are looked up in the repos file list index unless
+    // restricted to an edition or arch (see textQuery)
+    auto addFileListDependency = [&]( const std::string & name_r, const Capability & cap_r )
+    {
+      query.setFilesMatchFullPath( true );
+      if ( cap_r.detail().isVersioned() || ! cap_r.detail().arch().empty() )
+      {
+        query.addDependency( sat::SolvAttr::filelist, name_r, cap_r.detail().op(), cap_r.detail().ed(), Arch(cap_r.detail().arch()) );
+        queryAttributes = true;
+      }
+      else
+        searchFiles.push_back( name_r );
+    };
     // add argument strings and attributes to query
     for ( vector<string>::const_iterator it = _arguments.begin();
           it != _arguments.end(); ++it )
@@ -4268,8 +4486,7 @@ void Zypper::doCommand()
         {
           // in case of path names also search in file list
           attr = zypp::sat::SolvAttr::filelist;
-          query.setFilesMatchFullPath(true);
-          query.addDependency( attr , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()) );
+          addFileListDependency( name, cap );
         }
       }
       if (copts.count("requires"))
@@ -4300,8 +4517,7 @@ void Zypper::doCommand()
       if (copts.count("file-list"))
       {
         attr = zypp::sat::SolvAttr::filelist;
-	query.setFilesMatchFullPath( true );
-        query.addDependency( attr , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()) );
+        addFileListDependency( name, cap );
       }
       if ( attr == sat::SolvAttr::name || copts.count("name") )
       {
@@ -4314,14 +4530,23 @@ void Zypper::doCommand()
         // all strings without an edition match to all editions
         query.setMatchExact();
       }
-      // for search in summary and description use addAttribute
+      // search in summary and description (added as attributes below)
       if ( cOpts().count("search-descriptions") )
-      {
-        query.addAttribute(sat::SolvAttr::summary, name );
-        query.addAttribute(sat::SolvAttr::description, name );
-      }
+        searchTexts.push_back( name );
     }
 
+    // without repos, text and file list attributes (see textQuery)
+    zypp::PoolQuery unrestrictedQuery( query );
+    for ( const std::string & text : searchTexts )
+    {
+      query.addAttribute( sat::SolvAttr::summary, text );
+      query.addAttribute( sat::SolvAttr::description, text );
+    }
+    for ( const std::string & file : searchFiles )
+      query.addDependency( sat::SolvAttr::filelist, file );
+    for ( const std::string & alias : searchRepos )
+      query.addRepo( alias );
+
     init_target(*this);
 
     // now load resolvables:
@@ -4334,6 +4559,52 @@ void Zypper::doCommand()
 
     try
     {
+      // Unless the match details are needed ('verbose'), large pools are
+      // searched in forked children and summaries, descriptions and file
+      // lists are looked up in the repos full-text indexes. The result is
+      // the same as iterating query.selectableBegin() to query.selectableEnd().
+      std::vector<ui::Selectable::Ptr> selectables;
+      if ( command() != ZypperCommand::RUG_PATCH_SEARCH && ! _copts.count("verbose") )
+	selectables = selectablesOf( textQuery( unrestrictedQuery, searchTexts, searchFiles, searchRepos,
+						globalOpts().rm_options.repoSolvCachePath, queryAttributes ) );
+
+      // XML or JSON output of name sorted results (the common case) is written
+      // while iterating the selectables in name order; no Table needed.
+      if ( ( out().typeXML() || out().typeJSON() )
+	&& command() != ZypperCommand::RUG_PATCH_SEARCH
+	&& ! _copts.count("verbose")
+	&& ! ( details && copts.count("sort-by-repo") ) )
+      {
+	std::stable_sort( selectables.begin(), selectables.end(),
+			  []( const ui::Selectable::Ptr & lhs, const ui::Selectable::Ptr & rhs )->bool
+			  { return lhs->name() < rhs->name(); } );
+
+	std::unique_ptr<SearchResultSink> sink;
+	if ( out().typeXML() )
+	  sink.reset( new XmlSearchSink( cout ) );
+	else
+	  sink.reset( new JsonSearchSink( cout ) );
+
+	if ( details )
+	{
+	  FillSearchTableSolvable callback( t, inst_notinst, sink.get() );
+	  std::for_each( selectables.begin(), selectables.end(), callback );
+	}
+	else
+	{
+	  FillSearchTableSelectable callback( t, inst_notinst, sink.get() );
+	  std::for_each( selectables.begin(), selectables.end(), callback );
+	}
+	sink->finish();
+
+	if ( sink->empty() )
+	{
+	  out().info(_("No packages found."), Out::QUIET);
+	  setExitCode(ZYPPER_EXIT_INF_CAP_NOT_FOUND);
+	}
+	break;
+      }
+
       if (command() == ZypperCommand::RUG_PATCH_SEARCH)
       {
         FillPatchesTable callback(t, inst_notinst);
@@ -4350,12 +4621,12 @@ void Zypper::doCommand()
 	    callback( it );
 	}
 	else
-	  invokeOnEach(query.selectableBegin(), query.selectableEnd(), callback);
+	  std::for_each( selectables.begin(), selectables.end(), callback );
       }
       else
       {
         FillSearchTableSelectable callback(t, inst_notinst);
-        invokeOnEach(query.selectableBegin(), query.selectableEnd(), callback);
+        std::for_each( selectables.begin(), selectables.end(), callback );
       }
 
       if (t.empty())
@@ -4365,19 +4636,19 @@ void Zypper::doCommand()
       }
       else
       {
-        cout << endl; //! \todo  out().separator()?
+        out().info("", Out::QUIET, Out::TYPE_NORMAL); // visual separator
 
         if (command() == ZypperCommand::RUG_PATCH_SEARCH)
         {
           if (copts.count("sort-by-repo"))
-            t.sort(1);
+            t.sort( { 1, 3 } ); // sort by repo, name
           else
             t.sort(3); // sort by name
         }
         else if (_copts.count("details"))
         {
           if (copts.count("sort-by-repo"))
-            t.sort(5);
+            t.sort( { 5, 1 } ); // sort by repo, name
           else
             t.sort(1); // sort by name
         }
@@ -4842,6 +5113,13 @@ void Zypper::doCommand()
   {
     if (runningHelp()) { out().info(_command_help, Out::QUIET); return; }
 
+    if (out().typeJSON())
+    {
+      out().error("JSON output not implemented for this command.");
+      setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
+      return;
+    }
+
     if (_arguments.size() < 1)
     {
       out().error(_("Required argument missing."));
@@ -5056,7 +5334,7 @@ void Zypper::doCommand()
 
     if (copts.find("label") != copts.end())
     {
-      if (globalOpts().terse)
+      if (globalOpts().terse && !out().typeJSON())
       {
         cout << "labelLong\t" << str::escape(Target::distributionLabel(globalOpts().root_dir).summary, '\t') << endl;
         cout << "labelShort\t" << str::escape(Target::distributionLabel(globalOpts().root_dir).shortName, '\t') << endl;
@@ -5124,6 +5402,13 @@ void Zypper::doCommand()
   {
     if (runningHelp()) { out().info(_command_help, Out::QUIET); return; }
 
+    if (out().typeJSON())
+    {
+      out().error("JSON output not implemented for this command.");
+      setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
+      return;
+    }
+
     if (!_arguments.empty())
     {
       report_too_many_arguments(_command_help);
@@ -5169,6 +5454,7 @@ void Zypper::doCommand()
     {
       myOpts->_shortness = _copts["short"].size();
     }
+    myOpts->_changedSinceCommit = _copts.count( "changed-since-commit" );
 
     ps( *this );
     break;
@@ -5220,6 +5506,20 @@ void Zypper::doCommand()
     if ( _copts.count( "dry-run" ) )
       myOpts->_dryrun = true;
 
+    myOpts->_parallel = get_parallel_option( *this );
+    if ( _copts.count( "max-per-repo" ) )
+    {
+      const std::string & val( _copts["max-per-repo"].back() );
+      myOpts->_perrepo = str::strtonum<unsigned>( val );
+      if ( ! myOpts->_perrepo )
+      {
+	out().error( str::form(_("Invalid value '%s' of the %s option."), val.c_str(), "--max-per-repo") );
+	out().info(_("Expecting a number greater than zero."));
+	setExitCode( ZYPPER_EXIT_ERR_INVALID_ARGS );
+	return;
+      }
+    }
+
     download( *this );
     break;
   }
@@ -5244,6 +5544,8 @@ void Zypper::doCommand()
     if ( _copts.count( "dry-run" ) )
       myOpts->_dryrun = true;
 
+    myOpts->_parallel = get_parallel_option( *this );
+
     sourceDownload( *this );
 
     break;
@@ -5296,7 +5598,7 @@ void Zypper::doCommand()
     { TableRow tr; tr << "plaindir" << "Plaindir" << "Mount a directory of RPMs"; t << tr; }
     { TableRow tr; tr << "nu" << "NU" << "Novell Updates service"; t << tr; } // ris
 
-    cout << t;
+    out().table( t );
 
     break;
   }
@@ -5363,7 +5665,7 @@ void rug_list_resolvables(Zypper & zypper)
   { TableRow tr; tr << "pattern"; t << tr; }
   { TableRow tr; tr << "product"; t << tr; }
 
-  cout << t;
+  zypper.out().table( t );
 }
 
 
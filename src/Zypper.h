@@ -291,6 +291,7 @@ private:
   void processGlobalOptions();
   void processCommandOptions();
   void commandShell();
+  void commandShellDaemon();
   void shellCleanup();
   void safeDoCommand();
   void doCommand();
@@ -323,6 +324,7 @@ private:
 
   int _sh_argc;
   char **_sh_argv;
+  bool _sh_daemon;	//< shell --daemon
 
   /** Command specific options (see also _copts). */
   shared_ptr<Options>  _commandOptions;
@@ -6,11 +6,17 @@
 \*---------------------------------------------------------------------------*/
 
 #include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #include <zypp/base/LogTools.h>
 #include <zypp/Package.h>
 #include <zypp/ResPool.h>
 #include <zypp/PoolQuery.h>
+#include <zypp/Range.h>
+#include <zypp/sat/WhatProvides.h>
 #include <zypp/ZYppCallbacks.h>
 #include <zypp/ui/SelectableTraits.h>
 #include <zypp/target/CommitPackageCache.h>
@@ -20,6 +26,7 @@
 #include "Table.h"
 #include "download.h"
 #include "callbacks/media.h"
+#include "utils/ForkPool.h"
 
 ///////////////////////////////////////////////////////////////////
 // DownloadOptions
@@ -45,6 +52,12 @@ namespace
 
   public:
     void download();
+
+  private:
+    /** Download (or just report) a single package. */
+    void downloadItem( target::CommitPackageCache & packageCache, const PoolItem & pi, unsigned current, unsigned total );
+    /** Download \a items using forked jobs, reporting them in order. */
+    void downloadParallel( target::CommitPackageCache & packageCache, const std::vector<PoolItem> & items, unsigned total );
   };
   ///////////////////////////////////////////////////////////////////
 
@@ -72,6 +85,22 @@ namespace
     }
   }
 
+  /** Whether the name of a pkgspec is a glob pattern. */
+  inline bool isGlob( const std::string & name_r )
+  { return name_r.find_first_of( "*?[" ) != std::string::npos; }
+
+  /** Whether \a solv_r is a not installed package from \a pkgspec_r's repo and arch. */
+  inline bool matchesSpec( sat::Solvable solv_r, const PackageSpec & pkgspec_r, const CapDetail & capDetail_r )
+  {
+    if ( solv_r.isSystem() )
+      return false;
+    if ( ! pkgspec_r.repo_alias.empty() && solv_r.repository().alias() != pkgspec_r.repo_alias )
+      return false;
+    if ( ! capDetail_r.arch().empty() && solv_r.arch() != Arch( capDetail_r.arch() ) )
+      return false;
+    return true;
+  }
+
   void DownloadImpl::download()
   {
     typedef ui::SelectableTraits::AvailableItemSet AvailableItemSet;
@@ -81,46 +110,82 @@ namespace
     // parse package arguments
     PackageArgs::Options argopts;
     PackageArgs args( ResKind::package, argopts );
+    ResPool pool( ResPool::instance() );
+    std::vector<sat::Solvable> matches;
     for ( const auto & pkgspec : args.dos() )
     {
       const Capability & cap( pkgspec.parsed_cap );
       const CapDetail & capDetail( cap.detail() );
 
-      PoolQuery q;
-      q.setMatchGlob();
-      q.setUninstalledOnly();
-      q.addKind( ResKind::package );
-      if ( ! pkgspec.repo_alias.empty() )
-	q.addRepo( pkgspec.repo_alias );
-      //for_ ( it, repos.begin(), repos.end() ) q.addRepo(*it);
-      // try matching names first
-      q.addDependency( sat::SolvAttr::name,
-		       capDetail.name().asString(),
-		       capDetail.op(),			// defaults to Rel::ANY (NOOP) if no versioned cap
-		       capDetail.ed(),
-		       Arch( capDetail.arch() ) );	// defaults Arch_empty (NOOP) if no arch in cap
-
-      // no natch on names, do try provides
-      if ( q.empty() )
-	q.addDependency( sat::SolvAttr::provides,
+      // Plain names are looked up in the pools ident index and libsolvs
+      // whatprovides index, which does not scan the pool for each argument.
+      matches.clear();
+      if ( ! isGlob( capDetail.name().asString() ) )
+      {
+	// try matching names first
+	for_( it, pool.byIdentBegin( ResKind::package, capDetail.name() ), pool.byIdentEnd( ResKind::package, capDetail.name() ) )
+	{
+	  sat::Solvable solv( it->satSolvable() );
+	  if ( matchesSpec( solv, pkgspec, capDetail )
+	    && ( capDetail.op() == Rel::ANY
+	      || overlaps( Edition::MatchRange( Rel::EQ, solv.edition() ), Edition::MatchRange( capDetail.op(), capDetail.ed() ) ) ) )
+	    matches.push_back( solv );
+	}
+
+	// no match on names, do try provides
+	if ( matches.empty() )
+	{
+	  sat::WhatProvides q( Capability( capDetail.name().asString(), capDetail.op(), capDetail.ed() ) );
+	  for_( it, q.begin(), q.end() )
+	  {
+	    if ( it->isKind<Package>() && matchesSpec( *it, pkgspec, capDetail ) )
+	      matches.push_back( *it );
+	  }
+	}
+      }
+
+      // Glob patterns (and names matching case insensitive only) need a PoolQuery
+      if ( matches.empty() )
+      {
+	PoolQuery q;
+	q.setMatchGlob();
+	q.setUninstalledOnly();
+	q.addKind( ResKind::package );
+	if ( ! pkgspec.repo_alias.empty() )
+	  q.addRepo( pkgspec.repo_alias );
+	//for_ ( it, repos.begin(), repos.end() ) q.addRepo(*it);
+	// try matching names first
+	q.addDependency( sat::SolvAttr::name,
 			 capDetail.name().asString(),
 			 capDetail.op(),		// defaults to Rel::ANY (NOOP) if no versioned cap
 			 capDetail.ed(),
 			 Arch( capDetail.arch() ) );	// defaults Arch_empty (NOOP) if no arch in cap
 
-      if ( q.empty() )
+	// no natch on names, do try provides
+	if ( q.empty() )
+	  q.addDependency( sat::SolvAttr::provides,
+			   capDetail.name().asString(),
+			   capDetail.op(),		// defaults to Rel::ANY (NOOP) if no versioned cap
+			   capDetail.ed(),
+			   Arch( capDetail.arch() ) );	// defaults Arch_empty (NOOP) if no arch in cap
+
+	matches.insert( matches.end(), q.begin(), q.end() );
+      }
+
+      if ( matches.empty() )
       {
 	// translators: Label text; is followed by ': cmdline argument'
 	_zypper.out().warning( str::Str() << _("Argument resolves to no package") << ": " << pkgspec.orig_str );
 	continue;
       }
+      std::sort( matches.begin(), matches.end() );	// pool order, like PoolQuery
 
-      AvailableItemSet & avset( collect[(*q.begin()).ident()] );
+      AvailableItemSet & avset( collect[matches.front().ident()] );
       _zypper.out().info( str::Str() << pkgspec.orig_str << ": ", Out::HIGH );
-      for_( it, q.begin(), q.end() )
+      for ( const auto & solv : matches )
       {
-	avset.insert( PoolItem( *it ) );
-	_zypper.out().info( str::Str() << "  " << (*it).asUserString(), Out::HIGH );
+	avset.insert( PoolItem( solv ) );
+	_zypper.out().info( str::Str() << "  " << solv.asUserString(), Out::HIGH );
       }
     }
 
@@ -152,70 +217,219 @@ namespace
     target::CommitPackageCache packageCache( _zypper.globalOpts().root_dir );
     //packageCache.setCommitList( steps.begin(), steps.end() );
 
-    unsigned current = 0;
-    _zypper.runtimeData().commit_pkgs_total = total; // fix DownloadResolvableReport total counter
+    // the items to process, in output order
+    std::vector<PoolItem> items;
+    items.reserve( total );
     for ( const auto & ent : collect )
     {
       for ( const auto & pi : ent.second )
       {
-	++current;
-	Package::constPtr pkg( pi->asKind<Package>() );
-	if ( ! pkg->isCached() )
+	items.push_back( pi );
+	if ( !_options->_allmatches )
+	  break;	// first==best version only.
+      }
+    }
+
+    _zypper.runtimeData().commit_pkgs_total = total; // fix DownloadResolvableReport total counter
+    if ( _options->_parallel > 1 && !_options->_dryrun )
+    {
+      downloadParallel( packageCache, items, total );
+    }
+    else
+    {
+      unsigned current = 0;
+      for ( const auto & pi : items )
+	downloadItem( packageCache, pi, ++current, total );
+    }
+  }
+
+  void DownloadImpl::downloadItem( target::CommitPackageCache & packageCache, const PoolItem & pi, unsigned current, unsigned total )
+  {
+    Package::constPtr pkg( pi->asKind<Package>() );
+    if ( ! pkg->isCached() )
+    {
+      if ( !_options->_dryrun )
+      {
+	ManagedFile localfile;
+	try
 	{
-	  if ( !_options->_dryrun )
-	  {
-	    ManagedFile localfile;
-	    try
-	    {
-	      Out::ProgressBar report( _zypper.out(), Out::ProgressBar::noStartBar, pi.satSolvable().asUserString(), current, total );
-	      report.error(); // error if provideSrcPackage throws
-	      Out::DownloadProgress redirect( report );
-	      localfile = packageCache.get( pi );
-	      report.error( false );
-	      report.print( pkg->cachedLocation().asString() );
-	    }
-	    catch ( const Out::Error & error_r )
-	    {
-	      error_r.report( _zypper );
-	    }
-	    catch ( const AbortRequestException & exp )
-	    {
-	      ZYPP_RETHROW(exp);
-	    }
-	    catch ( const Exception & exp )
-	    {
-	      // TODO: Need class Out::Error support for exceptions
-	      ERR << exp << endl;
-	      _zypper.out().error( exp,
-				   boost::str( boost::format(_("Error downloading package '%s'.") ) % pi.satSolvable().asUserString() ) );
-	    }
-
-	    //DBG << localfile << endl;
-	    localfile.resetDispose();
-	    if ( _zypper.out().typeXML() )
-	      logXmlResult( pi, localfile );
-
-	    if ( _zypper.exitRequested() )
-	      throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
-	  }
-	  else
-	  {
-	    _zypper.out().info( str::Str()
-	                        << boost::str( boost::format(_("Not downloading package '%s'.") ) % pi.satSolvable().asUserString() )
-				<< " (--dry-run)" );
-	  }
+	  Out::ProgressBar report( _zypper.out(), Out::ProgressBar::noStartBar, pi.satSolvable().asUserString(), current, total );
+	  report.error(); // error if provideSrcPackage throws
+	  Out::DownloadProgress redirect( report );
+	  localfile = packageCache.get( pi );
+	  report.error( false );
+	  report.print( pkg->cachedLocation().asString() );
+	}
+	catch ( const Out::Error & error_r )
+	{
+	  error_r.report( _zypper );
+	}
+	catch ( const AbortRequestException & exp )
+	{
+	  ZYPP_RETHROW(exp);
+	}
+	catch ( const Exception & exp )
+	{
+	  // TODO: Need class Out::Error support for exceptions
+	  ERR << exp << endl;
+	  _zypper.out().error( exp,
+			       boost::str( boost::format(_("Error downloading package '%s'.") ) % pi.satSolvable().asUserString() ) );
+	}
+
+	//DBG << localfile << endl;
+	localfile.resetDispose();
+	if ( _zypper.out().typeXML() )
+	  logXmlResult( pi, localfile );
+
+	if ( _zypper.exitRequested() )
+	  throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+      }
+      else
+      {
+	_zypper.out().info( str::Str()
+			    << boost::str( boost::format(_("Not downloading package '%s'.") ) % pi.satSolvable().asUserString() )
+			    << " (--dry-run)" );
+      }
+    }
+    else
+    {
+      const Pathname &  localfile( pkg->cachedLocation() );
+      Out::ProgressBar report( _zypper.out(), localfile.asString(), current, total );
+      if ( _zypper.out().typeXML() )
+	logXmlResult( pi, localfile );
+    }
+  }
+
+  void DownloadImpl::downloadParallel( target::CommitPackageCache & packageCache, const std::vector<PoolItem> & items, unsigned total )
+  {
+    const unsigned maxJobs = _options->_parallel;
+    const unsigned maxPerRepo = _options->_perrepo ? _options->_perrepo : maxJobs;
+
+    // Only packages not yet cached are downloaded by jobs.
+    std::vector<unsigned> todo;	// indices into items
+    ByteCount todoSize;
+    for ( unsigned idx = 0; idx < items.size(); ++idx )
+    {
+      Package::constPtr pkg( items[idx]->asKind<Package>() );
+      if ( ! pkg->isCached() )
+      {
+	todo.push_back( idx );
+	todoSize += pkg->downloadSize();
+      }
+    }
+    MIL << "going to download " << todo.size() << " packages (" << todoSize << ") using "
+        << maxJobs << " jobs, " << maxPerRepo << " per repo" << endl;
+
+    ForkPool pool( maxJobs );
+    std::vector<int> job( items.size(), -1 );	// job index per item, -1 if not submitted
+    std::vector<unsigned> active;		// items with a (maybe finished) job we count as running
+    std::map<std::string,unsigned> perRepo;	// running jobs per repo alias
+    unsigned firstQueued = 0;			// first item in todo not yet submitted
+
+    // Forget jobs that finished meanwhile, then submit queued items
+    // in order, as far as the limits allow.
+    auto schedule = [&]()
+    {
+      for ( auto it = active.begin(); it != active.end(); )
+      {
+	if ( pool.done( job[*it] ) )
+	{
+	  --perRepo[items[*it].repository().alias()];
+	  it = active.erase( it );
 	}
 	else
+	  ++it;
+      }
+
+      for ( unsigned t = firstQueued; t < todo.size() && active.size() < maxJobs; ++t )
+      {
+	unsigned idx = todo[t];
+	if ( job[idx] >= 0 )
+	  continue;
+	unsigned & repoJobs( perRepo[items[idx].repository().alias()] );
+	if ( repoJobs >= maxPerRepo )
+	  continue;
+
+	PoolItem pi( items[idx] );
+	job[idx] = pool.submit( [this,&packageCache,pi]()->int {
+	  _zypper.globalOptsNoConst().non_interactive = true;
+	  ManagedFile localfile( packageCache.get( pi ) );
+	  localfile.resetDispose();
+	  return 0;
+	});
+	++repoJobs;
+	active.push_back( idx );
+      }
+
+      while ( firstQueued < todo.size() && job[todo[firstQueued]] >= 0 )
+	++firstQueued;
+    };
+
+    // Report all items in order. Failed jobs are retried in-process,
+    // which reports the error for the package.
+    auto start( std::chrono::steady_clock::now() );
+    ByteCount doneSize;
+    unsigned current = 0;
+    for ( unsigned idx = 0; idx < items.size(); ++idx )
+    {
+      ++current;
+      const PoolItem & pi( items[idx] );
+      Package::constPtr pkg( pi->asKind<Package>() );
+
+      schedule();
+      if ( job[idx] < 0 && ! pkg->isCached() )
+      {
+	// no job for this item yet; wait for a free slot
+	while ( job[idx] < 0 && ! active.empty() )
 	{
-	  const Pathname &  localfile( pkg->cachedLocation() );
-	  Out::ProgressBar report( _zypper.out(), localfile.asString(), current, total );
-	  if ( _zypper.out().typeXML() )
-	    logXmlResult( pi, localfile );
+	  pool.wait();
+	  schedule();
 	}
+      }
+      if ( job[idx] < 0 )
+      {
+	downloadItem( packageCache, pi, current, total );
+	continue;
+      }
 
-	if ( !_options->_allmatches )
-	  break;	// first==best version only.
+      // keep the other slots busy while this one is still downloading
+      while ( ! pool.done( job[idx] ) )
+      {
+	pool.wait();
+	schedule();
+      }
+      ForkPool::Result result( pool.collect( job[idx] ) );
+      schedule();	// refill the slot while we report
+
+      if ( result.exitCode != 0 || ! pkg->isCached() )
+      {
+	MIL << "download job for " << pi << " returned " << result.exitCode << ", retrying in-process" << endl;
+	DBG << result.output << endl;
+	downloadItem( packageCache, pi, current, total );
+	continue;
+      }
+
+      // aggregate throughput and estimated time left
+      doneSize += pkg->downloadSize();
+      double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      std::string stats;
+      if ( seconds > 0 && doneSize > 0 )
+      {
+	double rate = doneSize / seconds;
+	unsigned left = ( todoSize > doneSize ? ( todoSize - doneSize ) / rate : 0 );
+	stats = str::form( " [%s/s, %u:%02u left]", ByteCount( rate ).asString().c_str(), left / 60, left % 60 );
+      }
+
+      {
+	Out::ProgressBar report( _zypper.out(), Out::ProgressBar::noStartBar, pi.satSolvable().asUserString(), current, total );
+	report.error( false );
+	report.print( pkg->cachedLocation().asString() + stats );
       }
+      if ( _zypper.out().typeXML() )
+	logXmlResult( pi, pkg->cachedLocation() );
+
+      if ( _zypper.exitRequested() )
+	throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
     }
   }
 
@@ -29,6 +29,9 @@ class Zypper;
       "                     each matching package is downloaded.\n"
       "--dry-run            Don't download any package, just report waht\n"
       "                     would be done.\n"
+      "--parallel <N>       Download up to N packages at once.\n"
+      "--max-per-repo <N>   Download at most N packages at once from the\n"
+      "                     same repository.\n"
 */
 
 /** download specific options */
@@ -40,10 +43,14 @@ struct DownloadOptions : public Options
     : Options( ZypperCommand::DOWNLOAD)
     , _dryrun( false )
     , _allmatches( false )
+    , _parallel( 1 )
+    , _perrepo( 0 )
   {}
 
   int _dryrun;		//< Dryrun mode.
   int _allmatches;	//< Download all matching packages, not just the best one
+  unsigned _parallel;	//< Number of packages to download at once.
+  unsigned _perrepo;	//< Max. number of packages to download at once from the same repo (0: no limit).
 };
 
 /** Download rpms specified on the commandline to a local directory.
@@ -158,7 +158,7 @@ void list_locks(Zypper & zypper)
     if (t.empty())
       zypper.out().info(_("There are no package locks defined."));
     else
-      cout << t;
+      zypper.out().table( t );
   }
   catch(const Exception & e)
   {
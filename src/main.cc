@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstring>
 #include <signal.h>
 //#include <readline/readline.h>
 
@@ -7,6 +8,7 @@
 
 #include "main.h"
 #include "Zypper.h"
+#include "shell-daemon.h"
 
 #include "callbacks/rpm.h"
 #include "callbacks/keyring.h"
@@ -76,6 +78,19 @@ int main(int argc, char **argv)
   MIL << "===== Hi, me zypper " VERSION << endl;
   zypp::dumpRange( MIL, argv, argv+argc, "===== ", "'", "' '", "'", " =====" ) << endl;
 
+  // zypper --client: let a running 'zypper shell --daemon' do the job
+  if ( argc > 1 && ::strcmp( argv[1], "--client" ) == 0 )
+  {
+    int ret = shell_daemon_client( std::vector<std::string>( argv+2, argv+argc ) );
+    if ( ret >= 0 )
+      return ret;
+    // no daemon or not served: do it ourself
+    MIL << "Shell daemon not available; running the command in-process." << endl;
+    argv[1] = argv[0];
+    --argc;
+    ++argv;
+  }
+
   OutNormal out(Out::QUIET);
 
   if (::signal(SIGINT, signal_handler) == SIG_ERR)
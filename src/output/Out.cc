@@ -117,6 +117,11 @@ void Out::searchResult( const Table & table_r )
   std::cout << table_r;
 }
 
+void Out::table( const Table & table_r )
+{
+  std::cout << table_r;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //	class Out::Error
 ////////////////////////////////////////////////////////////////////////////////
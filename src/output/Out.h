@@ -277,7 +277,8 @@ public:
   enum TypeBit
   {
     TYPE_NORMAL = 0x01<<0,	///< plain text output
-    TYPE_XML    = 0x01<<1	///< xml output
+    TYPE_XML    = 0x01<<1,	///< xml output
+    TYPE_JSON   = 0x01<<2	///< newline delimited json output
   };
   ZYPP_DECLARE_FLAGS(Type,TypeBit);
 
@@ -401,6 +402,12 @@ public:
 	for_( it, begin_r, end_r ) mlist << ( *it );
       }
       break;
+      case TYPE_JSON:
+      {
+	// one message per element
+	for_( it, begin_r, end_r ) info( formater_r( *it ) );
+      }
+      break;
     }
   }
 
@@ -629,6 +636,16 @@ public:
    */
   virtual void searchResult( const Table & table_r );
 
+  /**
+   * Print out a \ref Table.
+   *
+   * Default implementation prints \a table_r on \c stdout. Commands
+   * printing a table as their result should use this rather than
+   * writing to \c stdout, so machine readable output types get the
+   * chance to convert it.
+   */
+  virtual void table( const Table & table_r );
+
   /**
    * Prompt the user for a decision.
    *
@@ -692,6 +709,8 @@ public:
   bool typeNORMAL() const { return type( TYPE_NORMAL ); }
   /** \overload test for TPE_XML */
   bool typeXML() const { return type( TYPE_XML ); }
+  /** \overload test for TYPE_JSON */
+  bool typeJSON() const { return type( TYPE_JSON ); }
 
   /** Terminal width or 150 if unlimited.
    * If a \a desired_r value is given, return the
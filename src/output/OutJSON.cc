@@ -0,0 +1,321 @@
+#include <iostream>
+#include <sstream>
+
+#include <zypp/base/String.h>
+
+#include "OutJSON.h"
+#include "utils/misc.h"
+#include "utils/prompt.h"
+#include "Table.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::ostringstream;
+
+///////////////////////////////////////////////////////////////////
+//	class JsonLine
+///////////////////////////////////////////////////////////////////
+
+JsonLine::JsonLine( string & buffer_r, const char * event_r )
+: _buf( buffer_r )
+{
+  _buf.clear();
+  _buf += '{';
+  str( "event", event_r );
+}
+
+void JsonLine::key( const char * key_r )
+{
+  switch ( _buf.back() )
+  {
+    case '{':
+    case '[':
+    case ':':
+      break;
+    default:
+      _buf += ',';
+      break;
+  }
+  if ( key_r )
+  {
+    quoted( key_r );
+    _buf += ':';
+  }
+}
+
+void JsonLine::quoted( boost::string_ref val_r )
+{
+  static const char hex[] = "0123456789abcdef";
+  _buf += '"';
+  for ( char ch : val_r )
+  {
+    switch ( ch )
+    {
+      case '"':  _buf += "\\\""; break;
+      case '\\': _buf += "\\\\"; break;
+      case '\n': _buf += "\\n"; break;
+      case '\t': _buf += "\\t"; break;
+      default:
+	if ( (unsigned char)ch < 0x20 )
+	{
+	  _buf += "\\u00";
+	  _buf += hex[(unsigned char)ch >> 4];
+	  _buf += hex[ch & 0xf];
+	}
+	else
+	  _buf += ch;	// UTF-8 is passed unchanged
+	break;
+    }
+  }
+  _buf += '"';
+}
+
+JsonLine & JsonLine::str( const char * key_r, boost::string_ref val_r )
+{
+  key( key_r );
+  quoted( val_r );
+  return *this;
+}
+
+JsonLine & JsonLine::num( const char * key_r, long long val_r )
+{
+  key( key_r );
+  _buf += zypp::str::numstring( val_r );
+  return *this;
+}
+
+JsonLine & JsonLine::flag( const char * key_r, bool val_r )
+{
+  key( key_r );
+  _buf += ( val_r ? "true" : "false" );
+  return *this;
+}
+
+JsonLine & JsonLine::beginObject( const char * key_r )
+{
+  key( key_r );
+  _buf += '{';
+  return *this;
+}
+
+JsonLine & JsonLine::endObject()
+{
+  _buf += '}';
+  return *this;
+}
+
+JsonLine & JsonLine::beginArray( const char * key_r )
+{
+  key( key_r );
+  _buf += '[';
+  return *this;
+}
+
+JsonLine & JsonLine::endArray()
+{
+  _buf += ']';
+  return *this;
+}
+
+void JsonLine::write( std::ostream & str_r, bool flush_r )
+{
+  _buf += "}\n";
+  str_r.write( _buf.data(), _buf.size() );
+  if ( flush_r )
+    str_r.flush();
+}
+
+///////////////////////////////////////////////////////////////////
+//	class OutJSON
+///////////////////////////////////////////////////////////////////
+
+OutJSON::OutJSON(Verbosity verbosity_r) : Out(TYPE_JSON, verbosity_r)
+{}
+
+OutJSON::~OutJSON()
+{ cout.flush(); }
+
+bool OutJSON::mine(Type type)
+{
+  if (type & Out::TYPE_JSON)
+    return true;
+  return false;
+}
+
+bool OutJSON::infoWarningFilter(Verbosity verbosity_r, Type mask)
+{
+  if (!mine(mask))
+    return true;
+  if (verbosity() < verbosity_r)
+    return true;
+  return false;
+}
+
+void OutJSON::writeMessage(const char * type, const string & msg, const string & hint)
+{
+  JsonLine line( _buffer, "message" );
+  line.str( "type", type ).str( "text", msg );
+  if (!hint.empty())
+    line.str( "hint", hint );
+  line.write( cout, true );
+}
+
+void OutJSON::info(const string & msg, Verbosity verbosity_r, Type mask)
+{
+  if (infoWarningFilter(verbosity_r, mask))
+    return;
+  writeMessage( "info", msg );
+}
+
+void OutJSON::warning(const string & msg, Verbosity verbosity_r, Type mask)
+{
+  if (infoWarningFilter(verbosity_r, mask))
+    return;
+  writeMessage( "warning", msg );
+}
+
+void OutJSON::error(const string & problem_desc, const string & hint)
+{
+  writeMessage( "error", problem_desc, hint );
+}
+
+void OutJSON::error(const zypp::Exception & e,
+                    const string & problem_desc,
+                    const string & hint)
+{
+  ostringstream s;
+  // problem
+  s << problem_desc << endl;
+  // cause
+  s << zyppExceptionReport(e);
+  writeMessage( "error", s.str(), hint );
+}
+
+void OutJSON::writeProgress(const string & id, const string & label,
+                            int value, bool done, bool error)
+{
+  JsonLine line( _buffer, "progress" );
+  line.str( "id", id ).str( "name", label );
+  if (done)
+    line.flag( "done", true ).flag( "error", error );
+  // print value only if it is known (percentage progress)
+  // missing value means 'is-alive' notification
+  else if (value >= 0)
+    line.num( "value", value );
+  line.write( cout, true );
+}
+
+void OutJSON::progressStart(const string & id,
+                            const string & label,
+                            bool has_range)
+{
+  if (progressFilter())
+    return;
+  writeProgress(id, label, has_range ? 0 : -1, false);
+}
+
+void OutJSON::progress(const string & id,
+                       const string& label,
+                       int value)
+{
+  if (progressFilter())
+    return;
+  writeProgress(id, label, value, false);
+}
+
+void OutJSON::progressEnd(const string & id, const string& label, bool error)
+{
+  if (progressFilter())
+    return;
+  writeProgress(id, label, 100, true, error);
+}
+
+void OutJSON::dwnldProgressStart(const zypp::Url & uri)
+{
+  JsonLine( _buffer, "download" )
+    .str( "url", uri.asString() )
+    .num( "percent", -1 )
+    .num( "rate", -1 )
+    .write( cout, true );
+}
+
+void OutJSON::dwnldProgress(const zypp::Url & uri,
+                            int value,
+                            long rate)
+{
+  JsonLine( _buffer, "download" )
+    .str( "url", uri.asString() )
+    .num( "percent", value )
+    .num( "rate", rate )
+    .write( cout, true );
+}
+
+void OutJSON::dwnldProgressEnd(const zypp::Url & uri, long rate, bool error)
+{
+  JsonLine( _buffer, "download" )
+    .str( "url", uri.asString() )
+    .num( "rate", rate )
+    .flag( "done", true )
+    .flag( "error", error )
+    .write( cout, true );
+}
+
+void OutJSON::searchResult( const Table & table_r )
+{
+  table( table_r );
+}
+
+void OutJSON::table( const Table & table_r )
+{
+  {
+    JsonLine line( _buffer, "table" );
+    line.beginArray( "header" );
+    for ( const string & col : table_r.header().columns() )
+      line.str( nullptr, col );
+    line.endArray().write( cout );
+  }
+  // one line per row, so a consumer can process them as they arrive
+  for ( const TableRow & row : table_r.rows() )
+  {
+    JsonLine line( _buffer, "row" );
+    line.beginArray( "columns" );
+    for ( const string & col : row.columns() )
+      line.str( nullptr, col );
+    line.endArray().write( cout );
+  }
+  cout.flush();
+}
+
+void OutJSON::prompt(PromptId id,
+                     const string & prompt,
+                     const PromptOptions & poptions,
+                     const string & startdesc)
+{
+  JsonLine line( _buffer, "prompt" );
+  line.num( "id", id );
+  if (!startdesc.empty())
+    line.str( "description", startdesc );
+  line.str( "text", prompt );
+
+  line.beginArray( "options" );
+  unsigned int i = 0;
+  for (PromptOptions::StrVector::const_iterator it = poptions.options().begin();
+       it != poptions.options().end(); ++it, ++i)
+  {
+    if (poptions.isDisabled(i))
+      continue;
+    line.beginObject()
+      .str( "value", *it )
+      .str( "desc", poptions.optionHelp(i) );
+    if (poptions.defaultOpt() == i)
+      line.flag( "default", true );
+    line.endObject();
+  }
+  line.endArray().write( cout, true );
+}
+
+void OutJSON::promptHelp(const PromptOptions & poptions)
+{
+  // nothing to do here
+}
@@ -0,0 +1,126 @@
+#ifndef OUTJSON_H_
+#define OUTJSON_H_
+
+#include <iosfwd>
+#include <string>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "Out.h"
+
+///////////////////////////////////////////////////////////////////
+/// \class JsonLine
+/// \brief Compose a single line JSON object in a reusable buffer.
+///
+/// Values are escaped and appended to the buffer as they are added,
+/// no temporary strings are created per member. Passing the same
+/// buffer for each line avoids reallocating it.
+/// \code
+///   std::string buffer;
+///   JsonLine( buffer, "message" )	// {"event":"message"
+///     .str( "type", "info" )		// ,"type":"info"
+///     .beginArray( "list" )		// ,"list":[
+///     .str( nullptr, "item" )		// "item"
+///     .endArray()			// ]
+///     .write( std::cout );		// }\n
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class JsonLine
+{
+public:
+  /** Ctor: clear \a buffer_r and start an object with member \c "event" : \a event_r. */
+  JsonLine( std::string & buffer_r, const char * event_r );
+
+  /** Add a string member (or array element if \a key_r is \c NULL). */
+  JsonLine & str( const char * key_r, boost::string_ref val_r );
+  /** Add a number member (or array element if \a key_r is \c NULL). */
+  JsonLine & num( const char * key_r, long long val_r );
+  /** Add a boolean member (or array element if \a key_r is \c NULL). */
+  JsonLine & flag( const char * key_r, bool val_r );
+
+  /** Start a nested object (member or array element if \a key_r is \c NULL). */
+  JsonLine & beginObject( const char * key_r = nullptr );
+  JsonLine & endObject();
+  /** Start a nested array (member or array element if \a key_r is \c NULL). */
+  JsonLine & beginArray( const char * key_r = nullptr );
+  JsonLine & endArray();
+
+  /** Close the object and write the line to \a str_r (flushed if \a flush_r). */
+  void write( std::ostream & str_r, bool flush_r = false );
+
+private:
+  void key( const char * key_r );
+  void quoted( boost::string_ref val_r );
+
+private:
+  std::string & _buf;
+};
+
+///////////////////////////////////////////////////////////////////
+/// \class OutJSON
+/// \brief Newline delimited JSON output (--json).
+///
+/// Each message, progress, prompt, table row or result is written
+/// as a single line JSON object with an \c "event" member telling
+/// its type.
+///////////////////////////////////////////////////////////////////
+class OutJSON : public Out
+{
+public:
+  OutJSON(Verbosity verbosity = NORMAL);
+  virtual ~OutJSON();
+
+public:
+  virtual void info(const std::string & msg, Verbosity verbosity = NORMAL, Type mask = TYPE_ALL);
+  virtual void warning(const std::string & msg, Verbosity verbosity = NORMAL, Type mask = TYPE_ALL);
+  virtual void error(const std::string & problem_desc, const std::string & hint = "");
+  virtual void error(const zypp::Exception & e,
+             const std::string & problem_desc,
+             const std::string & hint = "");
+
+  // progress
+  virtual void progressStart(const std::string & id,
+                             const std::string & label,
+                             bool is_tick = false);
+  virtual void progress(const std::string & id,
+                        const std::string & label,
+                        int value = -1);
+  virtual void progressEnd(const std::string & id,
+                           const std::string & label,
+                           bool error);
+
+  // progress with download rate
+  virtual void dwnldProgressStart(const zypp::Url & uri);
+  virtual void dwnldProgress(const zypp::Url & uri,
+                             int value = -1,
+                             long rate = -1);
+  virtual void dwnldProgressEnd(const zypp::Url & uri,
+                                long rate = -1,
+                                bool error = false);
+
+  virtual void searchResult( const Table & table_r );
+
+  virtual void table( const Table & table_r );
+
+  virtual void prompt(PromptId id,
+                      const std::string & prompt,
+                      const PromptOptions & poptions,
+                      const std::string & startdesc = "");
+
+  virtual void promptHelp(const PromptOptions & poptions);
+
+protected:
+  virtual bool mine(Type type);
+
+private:
+  bool infoWarningFilter(Verbosity verbosity, Type mask);
+  void writeMessage(const char * type, const std::string & msg, const std::string & hint = "");
+  void writeProgress(const std::string & id,
+                     const std::string & label,
+                     int value, bool done, bool error = false);
+
+private:
+  std::string _buffer;	///< reused for each line
+};
+
+#endif /*OUTJSON_H_*/
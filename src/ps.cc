@@ -6,10 +6,11 @@
 \*---------------------------------------------------------------------------*/
 
 #include <iostream>
+#include <fstream>
 
 #include <zypp/base/LogTools.h>
 #include <zypp/ExternalProgram.h>
-#include <zypp/misc/CheckAccessDeleted.h>
+#include <zypp/PathInfo.h>
 
 #include "Zypper.h"
 #include "Table.h"
@@ -19,6 +20,8 @@
 // PsOptions
 ///////////////////////////////////////////////////////////////////
 
+const Pathname PsOptions::_changedFilesRecord( "/var/cache/zypper/ps-changed-files" );
+
 inline std::ostream & operator<<( std::ostream & str, const PsOptions & obj )
 { return str << "PsOptions"; }
 
@@ -44,29 +47,40 @@ namespace
     void action();
 
   private:
+    const ProcScanner::ProcInfoList & loadData();
     void printServiceNamesOnly();
+
+  private:
+    ProcScanner _scanner;
   };
   ///////////////////////////////////////////////////////////////////
 
-  inline void loadData( zypp::CheckAccessDeleted & checker_r )
+  inline Pathname changedFilesRecord( Zypper & zypper_r )
+  { return Pathname::assertprefix( zypper_r.globalOpts().root_dir, PsOptions::_changedFilesRecord ); }
+
+  const ProcScanner::ProcInfoList & PsImpl::loadData()
   {
-    try
-    {
-      checker_r.check();
-    }
-    catch ( const zypp::Exception & ex )
-    {
-      throw( Out::Error( ZYPPER_EXIT_ERR_ZYPP, _("Check failed:"), ex ) );
-    }
+    if ( ! options()._changedSinceCommit )
+      return _scanner.scan();
+
+    Pathname record( changedFilesRecord( _zypper ) );
+    std::ifstream in( record.c_str() );
+    if ( ! in )
+      throw( Out::Error( ZYPPER_EXIT_ERR_ZYPP,
+			 _("No files removed by a commit are recorded."),
+			 str::form( _("Run '%s' to check all deleted files."), "zypper ps" ) ) );
+
+    ProcScanner::FileSet files;
+    for ( std::string line; std::getline( in, line ); )
+      files.insert( std::move(line) );
+    MIL << "Checking " << files.size() << " files recorded in " << record << endl;
+    return _scanner.scan( &files );
   }
 
   void PsImpl::printServiceNamesOnly()
   {
-    zypp::CheckAccessDeleted checker( false );	// wait for explicit call to check()
-    loadData( checker );
-
     std::set<std::string> services;
-    for ( const auto & procInfo : checker )
+    for ( const auto & procInfo : loadData() )
     {
       std::string service( procInfo.service() );
       if ( ! service.empty() )
@@ -102,8 +116,7 @@ namespace
 
     // Here: Table output
     _zypper.out().info(_("Checking for running processes using deleted libraries..."), Out::HIGH );
-    zypp::CheckAccessDeleted checker( false );	// wait for explicit call to check()
-    loadData( checker );
+    const ProcScanner::ProcInfoList & procInfos( loadData() );
 
     Table t;
     bool tableWithFiles = options().tableWithFiles();
@@ -131,7 +144,7 @@ namespace
       t << std::move(th);
     }
 
-    for ( const auto & procInfo : checker )
+    for ( const auto & procInfo : procInfos )
     {
       std::string service( procInfo.service() );
       if ( ! tableWithNonServiceProcs && service.empty() )
@@ -162,8 +175,9 @@ namespace
     else
     {
       _zypper.out().info(_("The following running processes use deleted files:") );
-      cout << endl;
-      cout << t << endl;
+      _zypper.out().info( "", Out::QUIET, Out::TYPE_NORMAL );
+      _zypper.out().table( t );
+      _zypper.out().info( "", Out::QUIET, Out::TYPE_NORMAL );
       _zypper.out().info(_("You may wish to restart these processes.") );
       _zypper.out().info( str::form( _("See '%s' for information about the meaning of values in the above table."),
 				     "man zypper" ) );
@@ -182,3 +196,28 @@ int ps( Zypper & zypper_r )
 {
   return PsImpl( zypper_r ).run();	// no final "Done"/"Finished with error." message!
 }
+
+void psRememberChangedFiles( Zypper & zypper_r, const ProcScanner::FileSet & files_r )
+{
+  Pathname record( changedFilesRecord( zypper_r ) );
+  Pathname tmp( record.extend( ".new" ) );
+  filesystem::assert_dir( record.dirname() );
+  {
+    std::ofstream out( tmp.c_str() );
+    for ( const std::string & file : files_r )
+      out << file << '\n';
+    if ( ! out.flush() )
+    {
+      WAR << "Can't write changed files record " << tmp << endl;
+      filesystem::unlink( tmp );
+      return;
+    }
+  }
+  if ( filesystem::rename( tmp, record ) != 0 )
+  {
+    WAR << "Can't write changed files record " << record << endl;
+    filesystem::unlink( tmp );
+    return;
+  }
+  MIL << "Recorded " << files_r.size() << " changed files in " << record << endl;
+}
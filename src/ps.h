@@ -8,6 +8,11 @@
 #define ZYPPER_PS_H
 
 #include <string>
+
+#include <zypp/Pathname.h>
+
+#include "utils/ProcScanner.h"
+
 class Zypper;
 
 /*
@@ -17,13 +22,17 @@ class Zypper;
 /** ps specific options */
 struct PsOptions : public Options
 {
+  static const zypp::Pathname _changedFilesRecord;
+
   PsOptions()
   : Options( ZypperCommand::PS )
   , _shortness( 0 )
+  , _changedSinceCommit( false )
   {}
 
   unsigned	_shortness;	//< 1:wo file, 2:only proc with services, 3:service names only
   std::string	_format;	//< format string for --print / shortness 3
+  bool		_changedSinceCommit;	//< only check files removed by the last commit
 
   bool tableWithFiles() const		{ return _shortness < 1; }
   bool tableWithNonServiceProcs() const	{ return _shortness < 2; }
@@ -34,4 +43,9 @@ struct PsOptions : public Options
  */
 int ps( Zypper & zypper_r );
 
+/** Remember the files removed or replaced by a commit for 'ps --changed-since-commit'.
+ * \a files_r are expected to be prefixed by the root directory already.
+ */
+void psRememberChangedFiles( Zypper & zypper_r, const ProcScanner::FileSet & files_r );
+
 #endif // ZYPPER_PS_H
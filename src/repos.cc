@@ -7,6 +7,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
 #include <boost/logic/tribool.hpp>
 #include <boost/lexical_cast.hpp>
 #include <iterator>
@@ -30,6 +33,8 @@
 #include "Table.h"
 #include "utils/messages.h"
 #include "utils/misc.h"
+#include "utils/ForkPool.h"
+#include "FullTextIndex.h"
 #include "repos.h"
 
 using namespace std;
@@ -369,6 +374,24 @@ static bool refresh_raw_metadata(Zypper & zypper,
 
 // ---------------------------------------------------------------------------
 
+/** Build the full-text indexes (texts and file lists) of the loaded \a repo unless
+ * they are up to date (see \ref FullTextIndex). Errors are logged only; search
+ * does not need them.
+ */
+static void build_fulltext_index(Zypper & zypper, const RepoInfo & repo)
+{
+  Repository robj = zypp::sat::Pool::instance().reposFind(repo.alias());
+  if (robj == Repository::noRepository)
+    return;
+
+  Pathname cachedir(zypper.globalOpts().rm_options.repoSolvCachePath / repo.escaped_alias());
+  for (FullTextIndex::Content content : { FullTextIndex::TEXTS, FullTextIndex::FILES })
+  {
+    if (!FullTextIndex(robj, cachedir, content).isValid())
+      FullTextIndex::build(robj, cachedir, content);
+  }
+}
+
 static bool build_cache(Zypper & zypper, const RepoInfo & repo, bool force_build)
 {
   if (force_build)
@@ -384,13 +407,14 @@ static bool build_cache(Zypper & zypper, const RepoInfo & repo, bool force_build
     // version of satsolver-tools. If there's a version mismatch or some other
     // problem, the solv file will be rebuilt even though the cookie files
     // indicate the solv file is up to date with raw metadata (bnc #456718)
-    if (!force_build &&
-        // only do this if the refresh commands are running
+    // The loaded repo is also needed to build the full-text index.
+    if (// only do this if the refresh commands are running
         // this function is also used when loading repos for other commands
-        (zypper.command() == ZypperCommand::REFRESH
-         || zypper.command() == ZypperCommand::REFRESH_SERVICES))
+        zypper.command() == ZypperCommand::REFRESH
+        || zypper.command() == ZypperCommand::REFRESH_SERVICES)
     {
       manager.loadFromCache(repo);
+      build_fulltext_index(zypper, repo);
     }
   }
   catch (const parser::ParseException & e)
@@ -988,6 +1012,7 @@ static void print_repo_list(Zypper & zypper,
 
   // repo number
   th << "#";
+  tbl.setNumericStyle( index );
 
   // alias
   if (all || showalias)
@@ -1035,6 +1060,7 @@ static void print_repo_list(Zypper & zypper,
     // translators: repository priority (in zypper repos -p or -d)
     th << _("Priority");
     ++index;
+    tbl.setNumericStyle( index );
     if (zypper.cOpts().count("sort-by-priority")
         || (list_cols.find("P") != string::npos && !sort_override))
       sort_index = index;
@@ -1121,7 +1147,7 @@ static void print_repo_list(Zypper & zypper,
     // sort
     tbl.sort(sort_index);
     // print
-    cout << tbl;
+    zypper.out().table( tbl );
   }
 }
 
@@ -1133,7 +1159,7 @@ static void print_repo_details(Zypper & zypper, list<RepoInfo> & repos)
   for_(it, repos.begin(), repos.end())
   {
     if (another)
-      cout << endl;
+      zypper.out().info("", Out::QUIET, Out::TYPE_NORMAL);
 
     RepoInfo repo = *it;
     RepoGpgCheckStrings repoGpgCheck( repo );
@@ -1162,7 +1188,7 @@ static void print_repo_details(Zypper & zypper, list<RepoInfo> & repos)
       << (  TableRow() << _("MD Cache Path")	<< repo.metadataPath() )
       ;
 
-    cout << t;
+    zypper.out().table( t );
     another = true;
   }
 }
@@ -1271,6 +1297,106 @@ void list_repos(Zypper & zypper)
 
 // ----------------------------------------------------------------------------
 
+/** Raw metadata refresh step of \ref refresh_repo.
+ * \return false on success, true on error
+ */
+static bool refresh_repo_download(Zypper & zypper, const RepoInfo & repo)
+{
+  bool force_download =
+    zypper.cOpts().count("force") || zypper.cOpts().count("force-download");
+
+  MIL << "calling refreshMetadata" << (force_download ? ", forced" : "")
+      << endl;
+
+  return refresh_raw_metadata(zypper, repo, force_download);
+}
+
+/** Cache building step of \ref refresh_repo.
+ * \return false on success, true on error
+ */
+static bool refresh_repo_build(Zypper & zypper, const RepoInfo & repo)
+{
+  bool force_build =
+    zypper.cOpts().count("force") || zypper.cOpts().count("force-build");
+
+  MIL << "calling buildCache" << (force_build ? ", forced" : "") << endl;
+
+  return build_cache(zypper, repo, force_build);
+}
+
+static void report_skipped_repo(Zypper & zypper, const RepoInfo & repo)
+{
+  zypper.out().error(boost::str(format(
+    _("Skipping repository '%s' because of the above error.")) % repo.asUserString()));
+  ERR << format("Skipping repository '%s' because of the above error.")
+      % repo.alias() << endl;
+}
+
+/** Refresh \a repos running the raw metadata download in up to
+ * \a jobs forked processes.
+ *
+ * Download and cache building are pipelined: While the cache of a repo
+ * is built, the downloads of the following repos continue. The number of
+ * repos downloaded ahead (running or waiting for their cache to be built)
+ * is limited to twice the number of jobs.
+ *
+ * The jobs output is replayed in repo order. A job never prompts; if
+ * it fails, the download is retried in-process so that the user is
+ * able to answer e.g. a request to import a new key.
+ *
+ * \return the number of repos which failed to refresh.
+ */
+static unsigned refresh_repos_forked(Zypper & zypper,
+                                     const std::vector<RepoInfo> & repos,
+                                     unsigned jobs)
+{
+  MIL << "going to refresh " << repos.size() << " repos using " << jobs << " jobs" << endl;
+
+  ForkPool pool(jobs);
+  const unsigned lookahead = 2 * jobs;
+  unsigned submitted = 0;
+
+  unsigned error_count = 0;
+  for (unsigned idx = 0; idx < repos.size(); ++idx)
+  {
+    for (; submitted < repos.size() && submitted < idx + lookahead; ++submitted)
+    {
+      const RepoInfo & repo(repos[submitted]);
+      pool.submit([&zypper,&repo]()->int {
+        zypper.globalOptsNoConst().non_interactive = true;
+        return refresh_repo_download(zypper, repo) ? 1 : 0;
+      });
+    }
+
+    // download stage
+    bool error = false;
+    ForkPool::Result result(pool.collect(idx));
+    if (result.exitCode == 0)
+    {
+      cout << result.output << std::flush;
+    }
+    else
+    {
+      MIL << "download job for '" << repos[idx].alias() << "' returned "
+          << result.exitCode << ", retrying in-process" << endl;
+      error = refresh_repo_download(zypper, repos[idx]);
+    }
+
+    // build stage (the next downloads are still running)
+    if (!(error || zypper.cOpts().count("download-only")))
+      error = refresh_repo_build(zypper, repos[idx]);
+
+    if (error)
+    {
+      report_skipped_repo(zypper, repos[idx]);
+      ++error_count;
+    }
+  }
+  return error_count;
+}
+
+// ----------------------------------------------------------------------------
+
 void refresh_repos(Zypper & zypper)
 {
   MIL << "going to refresh repositories" << endl;
@@ -1315,6 +1441,7 @@ void refresh_repos(Zypper & zypper)
 
   if (!specified.empty() || not_found.empty())
   {
+    std::vector<RepoInfo> torefresh;
     for (std::list<RepoInfo>::iterator it = repos.begin();
          it !=  repos.end(); ++it)
     {
@@ -1355,14 +1482,24 @@ void refresh_repos(Zypper & zypper)
         continue;
       }
 
-      // do the refresh
-      if (refresh_repo(zypper, repo))
+      torefresh.push_back(repo);
+    }
+
+    // do the refresh
+    unsigned jobs = get_parallel_option(zypper);
+    if (jobs > 1 && torefresh.size() > 1 && !zypper.cOpts().count("build-only"))
+    {
+      error_count = refresh_repos_forked(zypper, torefresh, jobs);
+    }
+    else
+    {
+      for (const RepoInfo & repo : torefresh)
       {
-        zypper.out().error(boost::str(format(
-          _("Skipping repository '%s' because of the above error.")) % repo.asUserString()));
-        ERR << format("Skipping repository '%s' because of the above error.")
-            % repo.alias() << endl;
-        error_count++;
+        if (refresh_repo(zypper, repo))
+        {
+          report_skipped_repo(zypper, repo);
+          error_count++;
+        }
       }
     }
   }
@@ -1407,26 +1544,11 @@ bool refresh_repo(Zypper & zypper, const zypp::RepoInfo & repo)
   // raw metadata refresh
   bool error = false;
   if (!zypper.cOpts().count("build-only"))
-  {
-    bool force_download =
-      zypper.cOpts().count("force") || zypper.cOpts().count("force-download");
-
-    MIL << "calling refreshMetadata" << (force_download ? ", forced" : "")
-        << endl;
-
-    error = refresh_raw_metadata(zypper, repo, force_download);
-  }
+    error = refresh_repo_download(zypper, repo);
 
   // db rebuild
   if (!(error || zypper.cOpts().count("download-only")))
-  {
-    bool force_build =
-      zypper.cOpts().count("force") || zypper.cOpts().count("force-build");
-
-    MIL << "calling buildCache" << (force_build ? ", forced" : "") << endl;
-
-    error = build_cache(zypper, repo, force_build);
-  }
+    error = refresh_repo_build(zypper, repo);
 
   return error;
 }
@@ -2655,7 +2777,7 @@ static void print_service_list(Zypper & zypper,
       tbl.sort(5);
 
     // print
-    cout << tbl;
+    zypper.out().table( tbl );
   }
 }
 
@@ -3313,6 +3435,37 @@ void load_resolvables(Zypper & zypper)
 
 // ---------------------------------------------------------------------------
 
+/** Ask the kernel to start reading the solv files of \a repos into the page
+ * cache. The reads happen in the background, while the preceding repos are
+ * parsed and added to the pool.
+ */
+static void prefetch_solv_files(Zypper & zypper, const std::vector<RepoInfo> & repos)
+{
+  for (const RepoInfo & repo : repos)
+  {
+    Pathname solvfile(zypper.globalOpts().rm_options.repoSolvCachePath / repo.escaped_alias() / "solv");
+    int fd = ::open(solvfile.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      DBG << "Can't prefetch " << solvfile << ": " << ::strerror(errno) << endl;
+      continue;
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    ::close(fd);
+  }
+}
+
+static void report_load_error(Zypper & zypper, const RepoInfo & repo, const Exception & e)
+{
+  zypper.out().error(e, boost::str(format(
+    _("Problem loading data from '%s'")) % repo.asUserString()),
+    // translators: the first %s is 'zypper refresh' and the second 'zypper clean -m'
+    boost::str(format(_("Try '%s', or even '%s' before doing so.")) % "zypper refresh" % "zypper clean -m")
+  );
+  zypper.out().info(boost::str(format(
+    _("Resolvables from '%s' not loaded because of error.")) % repo.asUserString()));
+}
+
 void load_repo_resolvables(Zypper & zypper)
 {
   RepoManager & manager = zypper.repoManager();
@@ -3320,13 +3473,15 @@ void load_repo_resolvables(Zypper & zypper)
 
   zypper.out().info(_("Loading repository data..."));
 
+  // Make sure the caches are there, then load them in repo order.
+  std::vector<RepoInfo> toload;
   for (std::list<RepoInfo>::iterator it = gData.repos.begin();
        it !=  gData.repos.end(); ++it)
   {
     RepoInfo repo(*it);
 
     if (it->enabled())
-      MIL << "Loading " << repo.alias() << " resolvables." << endl;
+      MIL << "Checking " << repo.alias() << " cache." << endl;
     else
     {
       DBG << "Skipping disabled repo '" << repo.alias() << "'" << endl;
@@ -3369,7 +3524,30 @@ void load_repo_resolvables(Zypper & zypper)
         }
       }
 
+      toload.push_back(repo);
+    }
+    catch (const Exception & e)
+    {
+      ZYPP_CAUGHT(e);
+      report_load_error(zypper, repo, e);
+    }
+  }
+
+  prefetch_solv_files(zypper, toload);
+
+  for (const RepoInfo & repo : toload)
+  {
+    MIL << "Loading " << repo.alias() << " resolvables." << endl;
+    try
+    {
+      std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
       manager.loadFromCache(repo);
+      std::chrono::milliseconds::rep msec = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+      MIL << "Loaded " << repo.alias() << " in " << msec << " ms" << endl;
+      zypper.out().info(boost::str(format(
+        // translators: %s is a repository name, %d a time in milliseconds
+        _("Loaded repository '%s' (%d ms).")) % repo.asUserString() % msec), Out::HIGH);
 
       // check that the metadata is not outdated
       // feature #301904
@@ -3391,13 +3569,7 @@ void load_repo_resolvables(Zypper & zypper)
     catch (const Exception & e)
     {
       ZYPP_CAUGHT(e);
-      zypper.out().error(e, boost::str(format(
-	_("Problem loading data from '%s'")) % repo.asUserString()),
-	// translators: the first %s is 'zypper refresh' and the second 'zypper clean -m'
-	boost::str(format(_("Try '%s', or even '%s' before doing so.")) % "zypper refresh" % "zypper clean -m")
-      );
-      zypper.out().info(boost::str(format(
-	_("Resolvables from '%s' not loaded because of error.")) % repo.asUserString()));
+      report_load_error(zypper, repo, e);
     }
   }
 }
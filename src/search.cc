@@ -1,4 +1,9 @@
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <memory>
+#include <unordered_set>
 
 #include <zypp/ZYpp.h> // for zypp::ResPool::instance()
 
@@ -8,6 +13,9 @@
 #include <zypp/Pattern.h>
 #include <zypp/Product.h>
 #include <zypp/sat/Solvable.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/base/StrMatcher.h>
+#include <zypp/sat/LookupAttr.h>
 
 #include <zypp/PoolItem.h>
 #include <zypp/PoolQuery.h>
@@ -16,7 +24,10 @@
 
 #include "main.h"
 #include "utils/misc.h" // for kind_to_string_localized and string_patch_status
+#include "utils/ForkPool.h"
 
+#include "output/OutJSON.h"
+#include "FullTextIndex.h"
 #include "search.h"
 
 using namespace zypp;
@@ -46,9 +57,346 @@ namespace
 } // namespace
 ///////////////////////////////////////////////////////////////////
 
+const char * SearchResultSink::statusName( const std::string & status_r )
+{
+  // test 1st char as locked is "iL"/"vL"
+  if ( ! status_r.empty() && status_r[0] == 'i' )
+    return "installed";
+  else if ( ! status_r.empty() && status_r[0] == 'v' )
+    return "other-version";
+  return "not-installed";
+}
+
+XmlSearchSink::XmlSearchSink( std::ostream & str_r )
+  : _str( str_r )
+  , _finished( false )
+{}
+
+void XmlSearchSink::add( const std::string & status_r, std::initializer_list<Attribute> attrs_r )
+{
+  if ( _finished )
+    return;
+
+  // compose the element and write it at once; no flush
+  std::string elem;
+  if ( _count == 0 )
+    elem = "<search-result version=\"0.0\">\n<solvable-list>\n";
+  ++_count;
+
+  elem += "<solvable status=\"";
+  elem += statusName( status_r );
+  elem += '"';
+
+  for ( const Attribute & attr : attrs_r )
+  {
+    elem += ' ';
+    elem += attr.first;
+    elem += "=\"";
+    elem += xml::escape( attr.second );
+    elem += '"';
+  }
+  elem += "/>\n";
+  _str << elem;
+}
+
+void XmlSearchSink::finish()
+{
+  if ( _finished )
+    return;
+  _finished = true;
+  if ( _count )
+    _str << "</solvable-list>\n</search-result>" << endl;
+}
+
+JsonSearchSink::JsonSearchSink( std::ostream & str_r )
+  : _str( str_r )
+{}
+
+void JsonSearchSink::add( const std::string & status_r, std::initializer_list<Attribute> attrs_r )
+{
+  ++_count;
+  JsonLine line( _buffer, "solvable" );
+  line.str( "status", statusName( status_r ) );
+  for ( const Attribute & attr : attrs_r )
+    line.str( attr.first, attr.second );
+  line.write( _str );	// no flush
+}
+
+void JsonSearchSink::finish()
+{
+  _str.flush();
+}
+
+// --------------------------------------------------------------------------
+
+namespace
+{
+  /** Don't fork for less than this number of solvables per job. */
+  const unsigned minSolvablesPerJob = 20000;
+
+  /** Append the solvables in \a repos_r matching \a query_r to \a result_r. */
+  void queryRepos( const PoolQuery & query_r, const std::vector<Repository> & repos_r, std::vector<sat::Solvable> & result_r )
+  {
+    if ( repos_r.empty() )
+      return;	// an unrestricted query would search all repos
+
+    PoolQuery query( query_r );
+    for ( const Repository & repo : repos_r )
+      query.addRepo( repo.alias() );
+    for_( it, query.begin(), query.end() )
+      result_r.push_back( *it );
+  }
+
+  /** Parse the solvable ids written by a search job; \c false if malformed. */
+  bool parseSolvableIds( const std::string & output_r, std::vector<sat::Solvable> & result_r )
+  {
+    std::vector<sat::Solvable> result;
+    const char * ptr = output_r.c_str();
+    while ( *ptr )
+    {
+      char * end = nullptr;
+      unsigned long id = ::strtoul( ptr, &end, 10 );
+      if ( end == ptr || *end != '\n' )
+	return false;
+      result.push_back( sat::Solvable( id ) );
+      ptr = end + 1;
+    }
+    result_r.insert( result_r.end(), result.begin(), result.end() );
+    return true;
+  }
+} // namespace
+
+std::vector<sat::Solvable> parallelQuery( const PoolQuery & query_r, const std::set<std::string> & repos_r, unsigned maxJobs_r )
+{
+  std::vector<Repository> repos;
+  unsigned solvables = 0;
+  for_( it, sat::Pool::instance().reposBegin(), sat::Pool::instance().reposEnd() )
+  {
+    if ( repos_r.empty() || repos_r.count( it->alias() ) )
+    {
+      repos.push_back( *it );
+      solvables += it->solvablesSize();
+    }
+  }
+
+  std::vector<sat::Solvable> ret;
+  if ( ! maxJobs_r )
+    maxJobs_r = std::max( std::thread::hardware_concurrency(), 1U );
+  unsigned jobs = std::min( { maxJobs_r, unsigned(repos.size()), solvables / minSolvablesPerJob } );
+  if ( jobs <= 1 )
+  {
+    queryRepos( query_r, repos, ret );
+    return ret;
+  }
+
+  // Largest repos first, each one to the group having the fewest solvables.
+  std::sort( repos.begin(), repos.end(),
+	     []( const Repository & lhs, const Repository & rhs )->bool
+	     { return lhs.solvablesSize() > rhs.solvablesSize(); } );
+  std::vector<std::vector<Repository>> groups( jobs );
+  std::vector<unsigned> groupSizes( jobs, 0 );
+  for ( const Repository & repo : repos )
+  {
+    unsigned idx = std::min_element( groupSizes.begin(), groupSizes.end() ) - groupSizes.begin();
+    groups[idx].push_back( repo );
+    groupSizes[idx] += repo.solvablesSize();
+  }
+  MIL << "Searching " << solvables << " solvables in " << repos.size() << " repos using " << jobs << " jobs" << endl;
+
+  ForkPool pool( jobs );
+  for ( const auto & group : groups )
+  {
+    pool.submit( [&query_r,&group]()->int {
+      std::vector<sat::Solvable> result;
+      queryRepos( query_r, group, result );
+      for ( const sat::Solvable & solv : result )
+	cout << solv.id() << '\n';
+      return 0;
+    } );
+  }
+
+  for ( unsigned idx = 0; idx < pool.size(); ++idx )
+  {
+    ForkPool::Result result( pool.collect( idx ) );
+    if ( result.exitCode == 0 && parseSolvableIds( result.output, ret ) )
+      continue;
+    WAR << "Search job " << idx << " failed (" << result.exitCode << "); searching its repos in-process" << endl;
+    queryRepos( query_r, groups[idx], ret );
+  }
+
+  // solvable ids are in pool order
+  std::sort( ret.begin(), ret.end(),
+	     []( const sat::Solvable & lhs, const sat::Solvable & rhs )->bool
+	     { return lhs.id() < rhs.id(); } );
+  return ret;
+}
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** The indexes of a repo needed by \ref textQuery. */
+  struct RepoIndexes
+  {
+    RepoIndexes( const Repository & repo_r, const Pathname & cacheDir_r, bool texts_r, bool files_r )
+    : texts( texts_r ? new FullTextIndex( repo_r, cacheDir_r, FullTextIndex::TEXTS ) : nullptr )
+    , files( files_r ? new FullTextIndex( repo_r, cacheDir_r, FullTextIndex::FILES ) : nullptr )
+    {}
+
+    bool isValid() const
+    { return ( ! texts || texts->isValid() ) && ( ! files || files->isValid() ); }
+
+    std::unique_ptr<FullTextIndex> texts;
+    std::unique_ptr<FullTextIndex> files;
+  };
+
+  /** Whether one of the file paths of \a solv_r matches \a matcher_r. */
+  bool fileListMatches( const sat::Solvable & solv_r, const StrMatcher & matcher_r )
+  {
+    sat::LookupAttr files( sat::SolvAttr::filelist, solv_r );
+    for_( it, files.begin(), files.end() )
+    {
+      if ( matcher_r.doMatch( it.c_str() ) )
+	return true;
+    }
+    return false;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+std::vector<sat::Solvable> textQuery( const PoolQuery & query_r,
+				      const std::vector<std::string> & texts_r,
+				      const std::vector<std::string> & files_r,
+				      const std::set<std::string> & repos_r,
+				      const Pathname & solvCachePath_r,
+				      bool queryAttributes_r,
+				      unsigned maxJobs_r )
+{
+  PoolQuery fullQuery( query_r );
+  for ( const std::string & text : texts_r )
+  {
+    fullQuery.addAttribute( sat::SolvAttr::summary, text );
+    fullQuery.addAttribute( sat::SolvAttr::description, text );
+  }
+  if ( ! files_r.empty() )
+  {
+    fullQuery.setFilesMatchFullPath( true );
+    for ( const std::string & file : files_r )
+      fullQuery.addDependency( sat::SolvAttr::filelist, file );
+  }
+
+  bool useIndex = ! ( texts_r.empty() && files_r.empty() ) && ! ( query_r.matchRegex() || query_r.matchGlob() );
+  for ( const std::vector<std::string> * strings : { &texts_r, &files_r } )
+  {
+    for ( const std::string & str : *strings )
+    {
+      // word matches are regex matches, don't mess with special chars
+      if ( ! FullTextIndex::isIndexable( str )
+	|| ( query_r.matchWord() && str.find_first_of( "\\^$.[]|()?*+{}" ) != std::string::npos ) )
+	useIndex = false;
+    }
+  }
+  if ( ! useIndex )
+    return parallelQuery( fullQuery, repos_r, maxJobs_r );
+
+  std::set<std::string> plainRepos;
+  std::set<std::string> indexedRepos;
+  std::vector<RepoIndexes> indexes;
+  for_( it, sat::Pool::instance().reposBegin(), sat::Pool::instance().reposEnd() )
+  {
+    if ( ! repos_r.empty() && ! repos_r.count( it->alias() ) )
+      continue;
+    if ( ! it->isSystemRepo() )
+    {
+      RepoIndexes index( *it, solvCachePath_r / it->info().escaped_alias(), ! texts_r.empty(), ! files_r.empty() );
+      if ( index.isValid() )
+      {
+	indexedRepos.insert( it->alias() );
+	indexes.push_back( std::move(index) );
+	continue;
+      }
+    }
+    plainRepos.insert( it->alias() );
+  }
+  if ( indexedRepos.empty() )
+    return parallelQuery( fullQuery, repos_r, maxJobs_r );
+  MIL << "Full-text index used for " << indexedRepos.size() << " of " << indexedRepos.size() + plainRepos.size() << " repos" << endl;
+
+  std::vector<sat::Solvable> ret;
+  if ( ! plainRepos.empty() )
+    ret = parallelQuery( fullQuery, plainRepos, maxJobs_r );
+  if ( queryAttributes_r )
+  {
+    // indexed repos: all but the indexed attributes via the query...
+    std::vector<sat::Solvable> found( parallelQuery( query_r, indexedRepos, maxJobs_r ) );
+    ret.insert( ret.end(), found.begin(), found.end() );
+  }
+
+  // ...the indexed attributes via the index candidates
+  Match mode( query_r.matchExact() ? Match::STRING : ( query_r.matchWord() ? Match::REGEX : Match::SUBSTRING ) );
+  if ( ! query_r.caseSensitive() )
+    mode |= Match::NOCASE;
+  auto matcher = [&query_r,mode]( const std::string & str_r )
+  { return StrMatcher( query_r.matchWord() ? "\\b" + str_r + "\\b" : str_r, mode ); };
+
+  const PoolQuery::Kinds & kinds( query_r.kinds() );
+  auto kindMatches = [&kinds]( const sat::Solvable & solv_r )
+  { return kinds.empty() || kinds.count( solv_r.kind() ); };
+
+  std::vector<sat::Solvable> candidates;
+  for ( const RepoIndexes & index : indexes )
+  {
+    for ( const std::string & text : texts_r )
+    {
+      StrMatcher textMatcher( matcher( text ) );
+      candidates.clear();
+      index.texts->candidates( text, candidates );
+      for ( const sat::Solvable & solv : candidates )
+      {
+	if ( kindMatches( solv )
+	  && ( textMatcher.doMatch( solv.lookupStrAttribute( sat::SolvAttr::summary ).c_str() )
+	    || textMatcher.doMatch( solv.lookupStrAttribute( sat::SolvAttr::description ).c_str() ) ) )
+	  ret.push_back( solv );
+      }
+    }
+    for ( const std::string & file : files_r )
+    {
+      StrMatcher fileMatcher( matcher( file ) );
+      candidates.clear();
+      index.files->candidates( file, candidates );
+      for ( const sat::Solvable & solv : candidates )
+      {
+	if ( kindMatches( solv ) && fileListMatches( solv, fileMatcher ) )
+	  ret.push_back( solv );
+      }
+    }
+  }
+
+  std::sort( ret.begin(), ret.end(),
+	     []( const sat::Solvable & lhs, const sat::Solvable & rhs )->bool
+	     { return lhs.id() < rhs.id(); } );
+  ret.erase( std::unique( ret.begin(), ret.end() ), ret.end() );
+  return ret;
+}
+
+std::vector<ui::Selectable::Ptr> selectablesOf( const std::vector<sat::Solvable> & solvables_r )
+{
+  std::vector<ui::Selectable::Ptr> ret;
+  std::unordered_set<const ui::Selectable *> seen;
+  for ( const sat::Solvable & solv : solvables_r )
+  {
+    ui::Selectable::Ptr sel( ui::Selectable::get( PoolItem( solv ) ) );
+    if ( sel && seen.insert( sel.get() ).second )
+      ret.push_back( sel );
+  }
+  return ret;
+}
+
+// --------------------------------------------------------------------------
+
 FillSearchTableSolvable::FillSearchTableSolvable(
-    Table & table, zypp::TriBool inst_notinst)
+    Table & table, zypp::TriBool inst_notinst, SearchResultSink * sink )
   : _table( &table )
+  , _sink( sink )
   , _gopts(Zypper::instance()->globalOpts())
   , _inst_notinst(inst_notinst)
 {
@@ -89,18 +437,18 @@ bool FillSearchTableSolvable::addPicklistItem( const ui::Selectable::constPtr &
   if ( pi->isKind<Pattern>() && ! pi->asKind<Pattern>()->userVisible() )
     return false;
 
-  TableRow row;
   // compute status indicator:
   //   i  - exactly this version installed
   //   v  - installed, but in different version
   //      - not installed at all
+  std::string status;
   bool isLocked = pi.status().isLocked();
   if ( pi->isSystem() )
   {
     // picklist: ==> not available
     if ( _inst_notinst == false )
       return false;	// show only not installed
-    row << lockStatusTag( "i", isLocked );
+    status = lockStatusTag( "i", isLocked );
   }
   else
   {
@@ -111,7 +459,7 @@ bool FillSearchTableSolvable::addPicklistItem( const ui::Selectable::constPtr &
     {
       if ( _inst_notinst == true )
 	return false;	// show only installed
-      row << lockStatusTag( "", isLocked );
+      status = lockStatusTag( "", isLocked );
     }
     else
     {
@@ -122,25 +470,38 @@ bool FillSearchTableSolvable::addPicklistItem( const ui::Selectable::constPtr &
       {
 	if ( _inst_notinst == false )
 	  return false;	// show only not installed
-	row << lockStatusTag( "i", isLocked );
+	status = lockStatusTag( "i", isLocked );
       }
       else
       {
 	if ( _inst_notinst == true )
 	  return false;	// show only installed
-	row << lockStatusTag( "v", isLocked );
+	status = lockStatusTag( "v", isLocked );
       }
     }
   }
 
+  std::string repo( pi->isSystem()
+		    ? (string("(") + _("System Packages") + ")")
+		    : pi->repository().asUserString() );
+  if ( _sink )
+  {
+    _sink->add( status, { { "name", pi->name() },
+			 { "kind", pi->kind().asString() },
+			 { "edition", pi->edition().asString() },
+			 { "arch", pi->arch().asString() },
+			 { "repository", std::move(repo) } } );
+    return true;
+  }
+
+  TableRow row;
   row
+    << std::move(status)
     << pi->name()
     << kind_to_string_localized( pi->kind(), 1 )
     << pi->edition().asString()
     << pi->arch().asString()
-    << ( pi->isSystem()
-       ? (string("(") + _("System Packages") + ")")
-       : pi->repository().asUserString() );
+    << std::move(repo);
 
   *_table << row;
   return true;	// actually added a row
@@ -155,6 +516,10 @@ bool FillSearchTableSolvable::operator()( const zypp::PoolQuery::const_iterator
   if ( ! operator()(*it) )
     return false;	// no row was added due to filter
 
+  // XML output shows no details
+  if ( _sink )
+    return true;
+
   // after addPicklistItem( const ui::Selectable::constPtr & sel, const PoolItem & pi ) is
   // done, add the details about matches to last row
   TableRow & lastRow = _table->rows().back();
@@ -215,8 +580,9 @@ bool FillSearchTableSolvable::operator()( const zypp::ui::Selectable::constPtr &
 
 
 FillSearchTableSelectable::FillSearchTableSelectable(
-    Table & table, zypp::TriBool installed_only)
+    Table & table, zypp::TriBool installed_only, SearchResultSink * sink )
   : _table( &table )
+  , _sink( sink )
   , _gopts(Zypper::instance()->globalOpts())
   , inst_notinst(installed_only)
 {
@@ -252,7 +618,7 @@ bool FillSearchTableSelectable::operator()(const zypp::ui::Selectable::constPtr
       return true;
   }
 
-  TableRow row;
+  std::string status;
 
   // whether to show the solvable as 'installed'
   bool installed = false;
@@ -284,7 +650,7 @@ bool FillSearchTableSelectable::operator()(const zypp::ui::Selectable::constPtr
       // not-installed only
       if (inst_notinst == false)
         return true;
-      row << lockStatusTag( "i", isLocked );
+      status = lockStatusTag( "i", isLocked );
     }
     // this happens if the solvable has installed objects, but no counterpart
     // of them in specified repos
@@ -293,14 +659,14 @@ bool FillSearchTableSelectable::operator()(const zypp::ui::Selectable::constPtr
       // not-installed only
       if (inst_notinst == true)
         return true;
-      row << lockStatusTag( "v", isLocked );
+      status = lockStatusTag( "v", isLocked );
     }
     else
     {
       // installed only
       if (inst_notinst == true)
         return true;
-      row << lockStatusTag( "", isLocked );
+      status = lockStatusTag( "", isLocked );
     }
   }
   else
@@ -308,9 +674,19 @@ bool FillSearchTableSelectable::operator()(const zypp::ui::Selectable::constPtr
     // installed only
     if (inst_notinst == true)
       return true;
-    row << lockStatusTag( "", isLocked );
+    status = lockStatusTag( "", isLocked );
   }
 
+  if ( _sink )
+  {
+    _sink->add( status, { { "name", s->name() },
+			 { "summary", s->theObj()->summary() },
+			 { "kind", s->kind().asString() } } );
+    return true;
+  }
+
+  TableRow row;
+  row << std::move(status);
   row << s->name();
   row << s->theObj()->summary();
   row << kind_to_string_localized(s->kind(), 1);
@@ -413,7 +789,7 @@ void list_patches(Zypper & zypper)
     zypper.out().info(_("No needed patches found."));
   else
     // display the result, even if --quiet specified
-    cout << tbl;
+    zypper.out().table( tbl );
 }
 
 static void list_patterns_xml(Zypper & zypper)
@@ -482,7 +858,7 @@ static void list_pattern_table(Zypper & zypper)
     zypper.out().info(_("No patterns found."));
   else
     // display the result, even if --quiet specified
-    cout << tbl;
+    zypper.out().table( tbl );
 }
 
 void list_patterns(Zypper & zypper)
@@ -520,10 +896,31 @@ void list_packages(Zypper & zypper)
 	  || ( unneeded && status_r.isUnneeded() ) );
   };
 
+  tbl << ( TableHeader()
+      // translators: S for installed Status
+      << _("S")
+      << _("Repository")
+      << _("Name")
+      << table::EditionStyleSetter( tbl, _("Version") )
+      << _("Arch") );
+
+  // If the output is piped, print rows as we go. They must be sorted
+  // by name then, and so must be the selectables. Other output types
+  // get the complete table via Out::table.
+  bool sortByRepo = copts.count("sort-by-repo");
+  bool streamed = !sortByRepo && zypper.out().typeNORMAL() && tbl.autoStream();
+
   const auto & pproxy( God->pool().proxy() );
-  for_( it, pproxy.byKindBegin(ResKind::package), pproxy.byKindEnd(ResKind::package) )
+  std::vector<ui::Selectable::Ptr> selectables( pproxy.byKindBegin(ResKind::package), pproxy.byKindEnd(ResKind::package) );
+  if ( streamed )
+  {
+    std::stable_sort( selectables.begin(), selectables.end(),
+		      []( const ui::Selectable::Ptr & lhs, const ui::Selectable::Ptr & rhs )->bool
+		      { return lhs->name() < rhs->name(); } );
+  }
+
+  for ( const ui::Selectable::Ptr & s : selectables )
   {
-    ui::Selectable::constPtr s = *it;
     // filter on selectable level
     if ( s->hasInstalledObj() )
     {
@@ -580,20 +977,12 @@ void list_packages(Zypper & zypper)
   else
   {
     // display the result, even if --quiet specified
-    tbl << ( TableHeader()
-	// translators: S for installed Status
-	<< _("S")
-	<< _("Repository")
-	<< _("Name")
-	<< table::EditionStyleSetter( tbl, _("Version") )
-	<< _("Arch") );
-
-    if (zypper.cOpts().count("sort-by-repo"))
-      tbl.sort(1); // Repo
-    else
+    if ( sortByRepo )
+      tbl.sort( { 1, 2 } ); // Repo, Name
+    else if ( ! streamed )
       tbl.sort(2); // Name
 
-    cout << tbl;
+    zypper.out().table( tbl );
   }
 }
 
@@ -731,7 +1120,7 @@ static void list_product_table(Zypper & zypper)
     zypper.out().info(_("No products found."));
   else
     // display the result, even if --quiet specified
-    cout << tbl;
+    zypper.out().table( tbl );
 }
 
 void list_products(Zypper & zypper)
@@ -789,7 +1178,7 @@ void list_what_provides(Zypper & zypper, const string & str)
 	fsts.addPicklistItem( sel, *it );
     }
   }
-  cout << t;
+  zypper.out().table( t );
 /*
 
   invokeOnEach(q.selectableBegin(), q.selectableEnd(), FillSearchTableSolvable(t) );
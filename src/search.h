@@ -8,6 +8,13 @@
 #ifndef ZYPPERSEARCH_H_
 #define ZYPPERSEARCH_H_
 
+#include <iosfwd>
+#include <initializer_list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <zypp/base/NonCopyable.h>
 #include <zypp/TriBool.h>
 #include <zypp/PoolQuery.h>
 
@@ -16,6 +23,144 @@
 
 //std::string selectable_search_repo_str(const zypp::ui::Selectable & s);
 
+///////////////////////////////////////////////////////////////////
+/// \class SearchResultSink
+/// \brief Base class for writing search results as soon as they are found.
+///
+/// Machine readable output types do not need the result to be formatted
+/// as a \ref Table first, so the \c FillSearchTable functors may pass
+/// each result to a sink instead.
+///////////////////////////////////////////////////////////////////
+class SearchResultSink : private zypp::base::NonCopyable
+{
+public:
+  typedef std::pair<const char *, std::string> Attribute;
+
+  virtual ~SearchResultSink()
+  {}
+
+  /** Write a result.
+   * \param status_r The tables status tag (\c "i", \c "v", or \c "", maybe followed by \c "L").
+   * \param attrs_r Further attributes in output order.
+   */
+  virtual void add( const std::string & status_r, std::initializer_list<Attribute> attrs_r ) = 0;
+
+  /** Close the result (if it was opened). */
+  virtual void finish()
+  {}
+
+  /** Number of results written. */
+  unsigned size() const
+  { return _count; }
+
+  bool empty() const
+  { return _count == 0; }
+
+protected:
+  SearchResultSink()
+  : _count( 0 )
+  {}
+
+  /** The status attribute value for the tables status tag. */
+  static const char * statusName( const std::string & status_r );
+
+protected:
+  unsigned _count;
+};
+
+///////////////////////////////////////////////////////////////////
+/// \class XmlSearchSink
+/// \brief Write search results as XML as soon as they are found.
+///
+/// Produces the same \c <search-result> as \ref OutXML::searchResult,
+/// but without building a \ref Table first. The document is opened on
+/// the first result and closed by the dtor (or \ref finish). Nothing is
+/// written if there are no results.
+///////////////////////////////////////////////////////////////////
+class XmlSearchSink : public SearchResultSink
+{
+public:
+  explicit XmlSearchSink( std::ostream & str_r );
+
+  ~XmlSearchSink()
+  { finish(); }
+
+  /** Write a \c <solvable> element (attribute values are escaped). */
+  virtual void add( const std::string & status_r, std::initializer_list<Attribute> attrs_r );
+
+  /** Close the document (if it was opened). */
+  virtual void finish();
+
+private:
+  std::ostream & _str;
+  bool _finished;
+};
+
+///////////////////////////////////////////////////////////////////
+/// \class JsonSearchSink
+/// \brief Write search results as JSON lines as soon as they are found.
+///
+/// Each result is a \c {"event":"solvable",...} line (see \ref OutJSON).
+///////////////////////////////////////////////////////////////////
+class JsonSearchSink : public SearchResultSink
+{
+public:
+  explicit JsonSearchSink( std::ostream & str_r );
+
+  /** Write a \c solvable event. */
+  virtual void add( const std::string & status_r, std::initializer_list<Attribute> attrs_r );
+
+  /** Flush the stream. */
+  virtual void finish();
+
+private:
+  std::ostream & _str;
+  std::string _buffer;	///< reused for each line
+};
+
+/** The solvables matching \a query_r in pool order.
+ *
+ * libzypp is not threadsafe, so the query is evaluated in up to
+ * \a maxJobs_r forked children (\c 0: one per CPU). The repos are
+ * split into one group per job of about the same number of solvables
+ * and each child searches one of them. Small pools are searched
+ * in-process. If a child fails, its repos are searched in-process.
+ *
+ * \a query_r must not be restricted to repos itself, the repos to
+ * search are passed in \a repos_r (all if empty).
+ */
+std::vector<zypp::sat::Solvable> parallelQuery( const zypp::PoolQuery & query_r,
+						const std::set<std::string> & repos_r,
+						unsigned maxJobs_r = 0 );
+
+/** Like \ref parallelQuery, but \a texts_r are also searched in the
+ * summaries and descriptions and \a files_r in the file lists (as if
+ * added to \a query_r as attributes, respectively as full path
+ * \ref zypp::sat::SolvAttr::filelist dependencies).
+ *
+ * Repos having a valid \ref FullTextIndex of the needed content in their
+ * directory below \a solvCachePath_r are searched for the index candidates
+ * only. This is done for substring, word and exact searches if all
+ * \a texts_r and \a files_r contain an indexed trigram. Otherwise, and for
+ * repos without index, the query is evaluated as usual.
+ *
+ * Pass \a queryAttributes_r \c false if \a query_r itself has no
+ * attributes, i.e. nothing but \a texts_r and \a files_r is searched
+ * (a \ref zypp::PoolQuery without attributes would match everything).
+ */
+std::vector<zypp::sat::Solvable> textQuery( const zypp::PoolQuery & query_r,
+					    const std::vector<std::string> & texts_r,
+					    const std::vector<std::string> & files_r,
+					    const std::set<std::string> & repos_r,
+					    const zypp::Pathname & solvCachePath_r,
+					    bool queryAttributes_r = true,
+					    unsigned maxJobs_r = 0 );
+
+/** The selectables of \a solvables_r in order of their first solvable
+ * (like \ref zypp::PoolQuery::selectableBegin).
+ */
+std::vector<zypp::ui::Selectable::Ptr> selectablesOf( const std::vector<zypp::sat::Solvable> & solvables_r );
+
 /**
  * Functor for filling search output table in rug style.
  */
@@ -23,6 +168,8 @@ struct FillSearchTableSolvable
 {
   // the table used for output
   Table * _table;
+  // if not NULL, results are written here instead of the table
+  SearchResultSink * _sink;
   const GlobalOptions & _gopts;
   /** Aliases of repos specified as --repo */
   std::set<std::string> _repos;
@@ -30,7 +177,8 @@ struct FillSearchTableSolvable
 
   FillSearchTableSolvable(
       Table & table,
-      zypp::TriBool inst_notinst = zypp::indeterminate );
+      zypp::TriBool inst_notinst = zypp::indeterminate,
+      SearchResultSink * sink = nullptr );
 
   /** Add all items within this Selectable */
   bool operator()( const zypp::ui::Selectable::constPtr & sel ) const;
@@ -54,13 +202,16 @@ struct FillSearchTableSelectable
 {
   // the table used for output
   Table * _table;
+  // if not NULL, results are written here instead of the table
+  SearchResultSink * _sink;
   const GlobalOptions & _gopts;
   /** Aliases of repos specified as --repo */
   std::set<std::string> _repos;
   zypp::TriBool inst_notinst;
 
   FillSearchTableSelectable(
-      Table & table, zypp::TriBool installed_only = zypp::indeterminate);
+      Table & table, zypp::TriBool installed_only = zypp::indeterminate,
+      SearchResultSink * sink = nullptr );
 
   bool operator()(const zypp::ui::Selectable::constPtr & s) const;
 };
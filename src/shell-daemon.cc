@@ -0,0 +1,402 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <sstream>
+#include <list>
+#include <cstring>
+#include <cstdlib>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/Exception.h>
+#include <zypp/base/String.h>
+#include <zypp/PathInfo.h>
+#include <zypp/ZConfig.h>
+
+#include "main.h"
+#include "shell-daemon.h"
+
+// libzypp logger settings
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypper"
+
+using namespace zypp;
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Max. size of a requests command line. */
+  const uint32_t maxRequestSize = 1024 * 1024;
+
+  inline bool writeAll( int fd_r, const void * buf_r, size_t size_r )
+  {
+    const char * buf = static_cast<const char *>( buf_r );
+    while ( size_r )
+    {
+      ssize_t n = ::write( fd_r, buf, size_r );
+      if ( n < 0 )
+      {
+	if ( errno == EINTR )
+	  continue;
+	return false;
+      }
+      buf += n;
+      size_r -= n;
+    }
+    return true;
+  }
+
+  inline bool readAll( int fd_r, void * buf_r, size_t size_r )
+  {
+    char * buf = static_cast<char *>( buf_r );
+    while ( size_r )
+    {
+      ssize_t n = ::read( fd_r, buf, size_r );
+      if ( n <= 0 )
+      {
+	if ( n < 0 && errno == EINTR )
+	  continue;
+	return false;
+      }
+      buf += n;
+      size_r -= n;
+    }
+    return true;
+  }
+
+  inline bool sockaddrFor( const std::string & path_r, sockaddr_un & addr_r )
+  {
+    ::memset( &addr_r, 0, sizeof(addr_r) );
+    addr_r.sun_family = AF_UNIX;
+    if ( path_r.size() >= sizeof(addr_r.sun_path) )
+      return false;
+    ::strcpy( addr_r.sun_path, path_r.c_str() );
+    return true;
+  }
+
+  /** Append \a path_r and its mtime (if it exists) to \a str_r. */
+  inline void stampPath( std::ostream & str_r, const Pathname & path_r )
+  {
+    PathInfo pi( path_r );
+    if ( pi.isExist() )
+      str_r << path_r << ':' << pi.mtime() << ';';
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+std::string shell_daemon_socket()
+{
+  const char * env = ::getenv( "ZYPPER_SOCKET" );
+  if ( env && *env )
+    return env;
+  return "/run/zypper-shell.socket";
+}
+
+bool shell_daemon_serves( const ZypperCommand & command_r )
+{
+  switch ( command_r.toEnum() )
+  {
+    case ZypperCommand::SEARCH_e:
+    case ZypperCommand::INFO_e:
+    case ZypperCommand::WHAT_PROVIDES_e:
+    case ZypperCommand::LIST_UPDATES_e:
+    case ZypperCommand::LIST_PATCHES_e:
+    case ZypperCommand::PATCH_CHECK_e:
+    case ZypperCommand::PACKAGES_e:
+    case ZypperCommand::PATCHES_e:
+    case ZypperCommand::PATTERNS_e:
+    case ZypperCommand::PRODUCTS_e:
+      return true;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+bool shell_daemon_selects_repos( const ZypperCommand & command_r, const std::vector<std::string> & args_r )
+{
+  // the list commands take repos as arguments
+  bool repoArgs = false;
+  switch ( command_r.toEnum() )
+  {
+    case ZypperCommand::PACKAGES_e:
+    case ZypperCommand::PATCHES_e:
+    case ZypperCommand::PATTERNS_e:
+    case ZypperCommand::PRODUCTS_e:
+      repoArgs = true;
+      break;
+
+    default:
+      break;
+  }
+
+  for ( unsigned i = 1; i < args_r.size(); ++i )
+  {
+    const std::string & arg( args_r[i] );
+    if ( arg == "--" )
+      return repoArgs && i + 1 < args_r.size();
+    if ( arg.compare( 0, 2, "--" ) == 0 )
+    {
+      std::string name( arg.substr( 2, arg.find( '=' ) - 2 ) );
+      if ( name == "repo" || name == "catalog" || name == "from" )
+	return true;
+    }
+    else if ( arg[0] == '-' && arg.size() > 1 )
+    {
+      // a cluster of short options; may be a false positive, which
+      // just makes the client run the command itself
+      if ( arg.find_first_of( "rc", 1 ) != std::string::npos )
+	return true;
+    }
+    else if ( repoArgs )
+      return true;
+  }
+  return false;
+}
+
+std::string shell_daemon_stamp( const RepoManagerOptions & options_r )
+{
+  std::ostringstream str;
+
+  // the rpm database, whichever location and backend is in use
+  for ( const char * dir : { "var/lib/rpm", "usr/lib/sysimage/rpm" } )
+  {
+    Pathname rpmdb( options_r.rootDir / dir );
+    stampPath( str, rpmdb );
+    for ( const char * file : { "Packages", "Packages.db", "rpmdb.sqlite" } )
+      stampPath( str, rpmdb / file );
+  }
+
+  // the locks (search status and list-updates use them)
+  stampPath( str, Pathname::assertprefix( options_r.rootDir, ZConfig::instance().locksFile() ) );
+
+  // the service and repo definitions, and the repos solv caches
+  stampPath( str, options_r.knownServicesPath );
+  stampPath( str, options_r.knownReposPath );
+  stampPath( str, options_r.repoSolvCachePath );
+  std::list<std::string> aliases;
+  filesystem::readdir( aliases, options_r.repoSolvCachePath, /*dots*/false );
+  for ( const std::string & alias : aliases )
+  {
+    stampPath( str, options_r.repoSolvCachePath / alias / "solv" );
+    stampPath( str, options_r.repoSolvCachePath / alias / "cookie" );
+  }
+
+  return str.str();
+}
+
+int shell_daemon_client( const std::vector<std::string> & args_r )
+{
+  sockaddr_un addr;
+  std::string path( shell_daemon_socket() );
+  if ( ! sockaddrFor( path, addr ) )
+    return -1;
+
+  int sock = ::socket( AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0 );
+  if ( sock < 0 )
+    return -1;
+
+  if ( ::connect( sock, (sockaddr*)&addr, sizeof(addr) ) < 0 )
+  {
+    DBG << "No shell daemon at " << path << ": " << ::strerror( errno ) << endl;
+    ::close( sock );
+    return -1;
+  }
+
+  std::string payload;
+  for ( const std::string & arg : args_r )
+  {
+    payload += arg;
+    payload += '\0';
+  }
+  uint32_t size = payload.size();
+
+  // request: size + our stdin/stdout/stderr, followed by the args
+  int fds[3] = { 0, 1, 2 };
+  char cbuf[CMSG_SPACE(sizeof(fds))];
+  ::memset( cbuf, 0, sizeof(cbuf) );
+
+  iovec iov;
+  iov.iov_base = &size;
+  iov.iov_len = sizeof(size);
+
+  msghdr msg;
+  ::memset( &msg, 0, sizeof(msg) );
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = cbuf;
+  msg.msg_controllen = sizeof(cbuf);
+
+  cmsghdr * cmsg = CMSG_FIRSTHDR( &msg );
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  ::memcpy( CMSG_DATA(cmsg), fds, sizeof(fds) );
+
+  ssize_t sent;
+  while ( ( sent = ::sendmsg( sock, &msg, 0 ) ) < 0 && errno == EINTR )
+  {;} // just loop
+  if ( sent != sizeof(size) || ! writeAll( sock, payload.data(), payload.size() ) )
+  {
+    ERR << "Can't send request to shell daemon: " << ::strerror( errno ) << endl;
+    ::close( sock );
+    return -1;
+  }
+
+  int32_t ret;
+  if ( ! readAll( sock, &ret, sizeof(ret) ) )
+  {
+    // The daemon may have written some output already, so we must not retry.
+    ERR << "Lost connection to shell daemon." << endl;
+    std::cerr << _("Lost connection to the zypper shell daemon.") << endl;
+    ret = ZYPPER_EXIT_ERR_BUG;
+  }
+  ::close( sock );
+
+  DBG << "Shell daemon returned " << ret << endl;
+  return ret;
+}
+
+///////////////////////////////////////////////////////////////////
+//	class ShellDaemon
+///////////////////////////////////////////////////////////////////
+
+ShellDaemon::ShellDaemon( const std::string & path_r )
+: _path( path_r )
+, _sock( -1 )
+{
+  sockaddr_un addr;
+  if ( ! sockaddrFor( _path, addr ) )
+    ZYPP_THROW( Exception( str::form( _("Socket path '%s' is too long."), _path.c_str() ) ) );
+
+  _sock = ::socket( AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0 );
+  if ( _sock < 0 )
+    ZYPP_THROW( Exception( str::form( _("Can't create socket: %s"), ::strerror( errno ) ) ) );
+
+  ::unlink( _path.c_str() );	// a stale socket of a previous instance
+  // create the socket 0600 right away, a chmod after bind leaves a window
+  mode_t mask = ::umask( 0177 );
+  int res = ::bind( _sock, (sockaddr*)&addr, sizeof(addr) );
+  int err_no = errno;
+  ::umask( mask );
+  if ( res == 0 )
+    res = ::listen( _sock, 16 );
+  else
+    errno = err_no;
+  if ( res < 0 )
+  {
+    std::string err( ::strerror( errno ) );
+    ::close( _sock );
+    ZYPP_THROW( Exception( str::form( _("Can't listen on socket '%s': %s"), _path.c_str(), err.c_str() ) ) );
+  }
+  MIL << "Shell daemon listening on " << _path << endl;
+}
+
+ShellDaemon::~ShellDaemon()
+{
+  if ( _sock >= 0 )
+  {
+    ::close( _sock );
+    ::unlink( _path.c_str() );
+  }
+  MIL << "Shell daemon stopped listening on " << _path << endl;
+}
+
+bool ShellDaemon::accept( Request & request_r )
+{
+  request_r = Request();
+
+  while ( true )
+  {
+    int conn = ::accept4( _sock, nullptr, nullptr, SOCK_CLOEXEC );
+    if ( conn < 0 )
+    {
+      if ( errno != EINTR )
+	ERR << "accept failed: " << ::strerror( errno ) << endl;
+      return false;
+    }
+    request_r.conn = conn;
+
+    // serve only ourself and root
+    ucred cred;
+    cred.uid = uid_t(-1);
+    socklen_t credlen = sizeof(cred);
+    if ( ::getsockopt( conn, SOL_SOCKET, SO_PEERCRED, &cred, &credlen ) < 0
+      || ( cred.uid != 0 && cred.uid != ::geteuid() ) )
+    {
+      WAR << "Refusing connection of uid " << int(cred.uid) << endl;
+      reply( request_r, -1 );
+      continue;
+    }
+
+    uint32_t size = 0;
+    char cbuf[CMSG_SPACE(sizeof(request_r.fd))];
+
+    iovec iov;
+    iov.iov_base = &size;
+    iov.iov_len = sizeof(size);
+
+    msghdr msg;
+    ::memset( &msg, 0, sizeof(msg) );
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    ssize_t got;
+    while ( ( got = ::recvmsg( conn, &msg, MSG_CMSG_CLOEXEC ) ) < 0 && errno == EINTR )
+    {;} // just loop
+
+    cmsghdr * cmsg = ( got == sizeof(size) ? CMSG_FIRSTHDR( &msg ) : nullptr );
+    if ( cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS
+      && cmsg->cmsg_len == CMSG_LEN(sizeof(request_r.fd)) )
+    {
+      ::memcpy( request_r.fd, CMSG_DATA(cmsg), sizeof(request_r.fd) );
+
+      std::string payload( size, '\0' );
+      if ( size <= maxRequestSize && readAll( conn, &payload[0], size ) )
+      {
+	std::string::size_type pos = 0;
+	for ( std::string::size_type end = payload.find( '\0' ); end != std::string::npos; end = payload.find( '\0', pos ) )
+	{
+	  request_r.args.push_back( payload.substr( pos, end-pos ) );
+	  pos = end + 1;
+	}
+	return true;
+      }
+    }
+
+    WAR << "Dropping malformed request." << endl;
+    reply( request_r, -1 );
+  }
+}
+
+void ShellDaemon::reply( Request & request_r, int exitCode_r )
+{
+  if ( request_r.conn >= 0 )
+  {
+    int32_t ret = exitCode_r;
+    if ( ! writeAll( request_r.conn, &ret, sizeof(ret) ) )
+      WAR << "Can't send reply: " << ::strerror( errno ) << endl;
+    ::close( request_r.conn );
+  }
+  for ( int & fd : request_r.fd )
+  {
+    if ( fd >= 0 )
+      ::close( fd );
+  }
+  request_r = Request();
+}
@@ -0,0 +1,96 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_SHELL_DAEMON_H_
+#define ZYPPER_SHELL_DAEMON_H_
+
+#include <string>
+#include <vector>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/RepoManager.h>
+
+#include "Command.h"
+
+/** The socket used by 'zypper shell --daemon' and 'zypper --client'.
+ * Either \c $ZYPPER_SOCKET or \c /run/zypper-shell.socket.
+ */
+std::string shell_daemon_socket();
+
+/** Whether the shell daemon serves \a command_r.
+ * Only commands which do not modify the system or the pool are served.
+ */
+bool shell_daemon_serves( const ZypperCommand & command_r );
+
+/** Whether \a args_r (command and command options) select repositories
+ * (\c -r/--repo, \c --from, or repo arguments of the list commands).
+ *
+ * The daemons pool is loaded once with all enabled repos, so it can't
+ * serve these requests like an in-process run would.
+ */
+bool shell_daemon_selects_repos( const ZypperCommand & command_r, const std::vector<std::string> & args_r );
+
+/** A stamp of the rpm database, the locks, the service and repository
+ * definitions and the repository caches in use.
+ * If it changes, the daemons pool is outdated.
+ */
+std::string shell_daemon_stamp( const zypp::RepoManagerOptions & options_r );
+
+/** Forward \a args_r (command and command options) to a running shell daemon
+ * (zypper --client).
+ *
+ * The daemon runs the command using our stdin/stdout/stderr.
+ *
+ * \return The commands exit code, or \c -1 if there is no daemon listening,
+ * or it refused to execute the command. The caller should run the command
+ * itself then.
+ */
+int shell_daemon_client( const std::vector<std::string> & args_r );
+
+///////////////////////////////////////////////////////////////////
+/// \class ShellDaemon
+/// \brief Server side of the shell daemon socket.
+///
+/// Clients pass their stdin/stdout/stderr and the command line
+/// to execute. The daemon replies the commands exit code, or \c -1
+/// if it refuses to execute the command.
+///////////////////////////////////////////////////////////////////
+class ShellDaemon : private zypp::base::NonCopyable
+{
+public:
+  /** A clients request */
+  struct Request
+  {
+    Request() : conn( -1 ), fd { -1, -1, -1 } {}
+    int conn;				///< the connection
+    int fd[3];				///< the clients stdin/stdout/stderr
+    std::vector<std::string> args;	///< command and command options
+  };
+
+public:
+  /** Ctor: Listen on \a path_r.
+   * \throws zypp::Exception if the socket can not be created.
+   */
+  ShellDaemon( const std::string & path_r );
+
+  /** Dtor: Stop listening and remove the socket. */
+  ~ShellDaemon();
+
+  /** Wait for the next request.
+   * \return \c false if the socket is broken (or on signal).
+   */
+  bool accept( Request & request_r );
+
+  /** Send the commands \a exitCode_r and close the \a request_r. */
+  void reply( Request & request_r, int exitCode_r );
+
+private:
+  std::string _path;
+  int _sock;
+};
+
+#endif /* ZYPPER_SHELL_DAEMON_H_ */
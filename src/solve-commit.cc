@@ -16,7 +16,7 @@
 #include <zypp/base/IOStream.h>
 
 #include <zypp/media/MediaException.h>
-#include <zypp/misc/CheckAccessDeleted.h>
+#include <zypp/Package.h>
 
 #include "misc.h"              // confirm_licenses
 #include "repos.h"              // get_repo - used in dist_upgrade
@@ -24,6 +24,7 @@
 #include "utils/prompt.h"      // Continue? and solver problem prompt
 #include "utils/pager.h"       // to view the summary
 #include "Summary.h"
+#include "ps.h"
 
 #include "solve-commit.h"
 
@@ -440,34 +441,48 @@ ZYppCommitPolicy get_commit_policy(Zypper & zypper)
   return policy;
 }
 
+/** The files of installed packages which are removed or replaced by the
+ * commit (prefixed by the root directory). Running processes may continue
+ * to use them after the commit.
+ */
+static ProcScanner::FileSet files_removed_by_commit(Zypper & zypper)
+{
+  ProcScanner::FileSet files;
+  const Pathname & root( zypper.globalOpts().root_dir );
+  for_( it, God->pool().byKindBegin<Package>(), God->pool().byKindEnd<Package>() )
+  {
+    if ( ! ( it->status().isInstalled() && it->status().isToBeUninstalled() ) )
+      continue;
+    for ( const std::string & file : asKind<Package>( *it )->filelist() )
+      files.insert( Pathname::assertprefix( root, file ).asString() );
+  }
+  MIL << files.size() << " files are removed or replaced by the commit" << endl;
+  return files;
+}
+
 /** fate #300763
  * This is called after each commit to notify user about running processes that
  * use libraries or other files that have been removed since their execution.
+ * Only \a files_r, the files removed by the commit, are checked.
  */
-static void notify_processes_using_deleted_files(Zypper & zypper)
+static void notify_processes_using_deleted_files(Zypper & zypper, const ProcScanner::FileSet & files_r)
 {
+  psRememberChangedFiles( zypper, files_r );
+
   if ( ! zypper.config().psCheckAccessDeleted )
   {
     zypper.out().info( str::form(_("Check for running processes using deleted libraries is disabled in zypper.conf. Run '%s' to check manually."),
-				 "zypper ps -s" ) );
+				 "zypper ps -s --changed-since-commit" ) );
     return;	// disabled in config
   }
 
   zypper.out().info(
       _("Checking for running processes using deleted libraries..."), Out::HIGH);
-  zypp::CheckAccessDeleted checker(false); // wait for explicit call to check()
-  try
-  {
-    checker.check();
-  }
-  catch(const zypp::Exception & e)
-  {
-    if (zypper.out().verbosity() > Out::NORMAL)
-      zypper.out().error(e, _("Check failed:"));
-  }
+  ProcScanner scanner;
+  const ProcScanner::ProcInfoList & procInfos( scanner.scan( &files_r ) );
 
   // Don't suggest "zypper ps" if zypper is the only prog with deleted open files.
-  if (checker.size() > 1 || (checker.size() == 1 && checker.begin()->pid != zypp::str::numstring(::getpid())))
+  if (procInfos.size() > 1 || (procInfos.size() == 1 && procInfos.front().pid != zypp::str::numstring(::getpid())))
   {
     zypper.out().info(str::form(
         _("There are some running programs that might use files deleted by recent upgrade."
@@ -620,6 +635,8 @@ void solve_and_commit (Zypper & zypper)
     // show the summary
     if (zypper.out().type() == Out::TYPE_XML)
       summary.dumpAsXmlTo(cout);
+    else if (zypper.out().type() == Out::TYPE_JSON)
+      summary.dumpAsJsonTo(cout);
     else
       summary.dumpTo(cout);
 
@@ -778,6 +795,7 @@ void solve_and_commit (Zypper & zypper)
           return;
 	}
 
+        ProcScanner::FileSet changed_files;
         try
         {
           RuntimeData & gData = Zypper::instance()->runtimeData();
@@ -801,6 +819,10 @@ void solve_and_commit (Zypper & zypper)
 	    zypper.out().info( s.str(), Out::HIGH );
 	  }
 
+          // remember what is about to be removed; the pool is reloaded by the commit
+          if ( ! ( copts.count("download-only") || copts.count("dry-run") ) )
+            changed_files = files_removed_by_commit(zypper);
+
           ZYppCommitResult result = God->commit(get_commit_policy(zypper));
           gData.show_media_progress_hack = false;
 	  gData.entered_commit = false;
@@ -936,7 +958,7 @@ void solve_and_commit (Zypper & zypper)
 	    || summary.packagesToUpgrade()
 	    || summary.packagesToDowngrade() ) )
 	{
-          notify_processes_using_deleted_files(zypper);
+          notify_processes_using_deleted_files(zypper, changed_files);
 	}
       }
     }
@@ -6,8 +6,12 @@
 \*---------------------------------------------------------------------------*/
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
 
 #include <zypp/base/LogTools.h>
+#include <zypp/TmpPath.h>
 #include <zypp/ResPool.h>
 #include <zypp/Package.h>
 #include <zypp/SrcPackage.h>
@@ -17,6 +21,7 @@
 
 #include "Zypper.h"
 #include "Table.h"
+#include "utils/ForkPool.h"
 #include "source-download.h"
 
 ///////////////////////////////////////////////////////////////////
@@ -25,6 +30,7 @@
 
 const Pathname SourceDownloadOptions::_defaultDirectory( "/var/cache/zypper/source-download" );
 const std::string SourceDownloadOptions::_manifestName( "MANIFEST" );
+const std::string SourceDownloadOptions::_headerCacheName( "MANIFEST.headers" );
 
 inline std::ostream & operator<<( std::ostream & str, const SourceDownloadOptions & obj )
 {
@@ -150,6 +156,11 @@ namespace
     /** Startup and build manifest. */
     void buildManifest();
 
+    /** Download a single source package (reporting errors). */
+    void downloadSrcPackage( SourcePkg & spkg, repo::SrcPackageProvider & prov, unsigned current, unsigned total );
+    /** Download source packages using forked jobs; return those which failed. */
+    std::vector<SourcePkg*> downloadParallel( const std::vector<SourcePkg*> & missing );
+
     std::ostream & dumpManifestSumary( std::ostream & str, Manifest::StatusMap & status );
     std::ostream & dumpManifestTable( std::ostream & str );
 
@@ -186,6 +197,162 @@ namespace
     return str;
   }
 
+  ///////////////////////////////////////////////////////////////////
+  /// \class HeaderCache
+  /// \brief Persistent index of the rpm headers read from the download directory.
+  ///
+  /// Remembers the srpm longname (or that it is no srpm at all) for each
+  /// file, keyed by inode, mtime and size. Unchanged files need not to be
+  /// opened again. One line per file:
+  /// \code
+  ///   <inode> <mtime> <size> <longname or '-'> <filename>
+  /// \endcode
+  ///////////////////////////////////////////////////////////////////
+  struct HeaderCache
+  {
+    struct Entry
+    {
+      Entry() : ino( 0 ), mtime( 0 ), size( 0 ) {}
+
+      Entry( const PathInfo & pi_r, const std::string & longname_r )
+      : ino( pi_r.ino() ), mtime( pi_r.mtime() ), size( pi_r.size() ), longname( longname_r ) {}
+
+      bool matches( const PathInfo & pi_r ) const
+      { return ino == (unsigned long long)pi_r.ino() && mtime == (long long)pi_r.mtime() && size == (unsigned long long)pi_r.size(); }
+
+      unsigned long long ino;
+      long long mtime;
+      unsigned long long size;
+      std::string longname;	//< empty if not a srpm
+    };
+
+    /** Read the index from \a file_r; a missing or malformed file leaves it empty. */
+    void read( const Pathname & file_r )
+    {
+      std::ifstream in( file_r.c_str() );
+      for ( std::string line; std::getline( in, line ); )
+      {
+	std::istringstream str( line );
+	Entry entry;
+	std::string longname;
+	str >> entry.ino >> entry.mtime >> entry.size >> longname;
+	std::string::size_type pos = str.tellg();
+	if ( ! str || longname.empty() || pos == std::string::npos || pos+1 >= line.size() )
+	{
+	  WAR << "Ignore malformed header cache " << file_r << endl;
+	  _entries.clear();
+	  return;
+	}
+	if ( longname != "-" )
+	  entry.longname.swap( longname );
+	_entries[line.substr( pos+1 )] = std::move(entry);
+      }
+      MIL << "Header cache " << file_r << ": " << _entries.size() << " entries" << endl;
+    }
+
+    /** Write the index to \a file_r (replaced atomically). */
+    void write( const Pathname & file_r ) const
+    {
+      Pathname tmp( file_r.extend( ".new" ) );
+      {
+	std::ofstream out( tmp.c_str() );
+	for ( const auto & item : _entries )
+	{
+	  const Entry & entry( item.second );
+	  out << entry.ino << ' ' << entry.mtime << ' ' << entry.size << ' '
+	      << ( entry.longname.empty() ? "-" : entry.longname ) << ' ' << item.first << '\n';
+	}
+	if ( ! out.flush() )
+	{
+	  WAR << "Can't write header cache " << tmp << endl;
+	  filesystem::unlink( tmp );
+	  return;
+	}
+      }
+      if ( filesystem::rename( tmp, file_r ) != 0 )
+      {
+	WAR << "Can't write header cache " << file_r << endl;
+	filesystem::unlink( tmp );
+      }
+    }
+
+    std::map<std::string, Entry> _entries;
+  };
+
+  /** The srpm longname stored in \a path_r, or an empty string if it is not a srpm. */
+  inline std::string readSrcLongname( const Pathname & path_r )
+  {
+    using target::rpm::RpmHeader;
+    RpmHeader::constPtr pkg( RpmHeader::readPackage( path_r, RpmHeader::NOVERIFY ) );
+    if ( ! ( pkg && pkg->isSrc() ) )
+      return std::string();
+    return SourceDownloadImpl::SourcePkg::makeLongname( pkg->tag_name(), pkg->tag_edition(), pkg->isNosrc() );
+  }
+
+  /** Read the srpm longnames of \a paths_r, using forked jobs if there are many.
+   * Returns the longnames in the order of \a paths_r. Headers are read in
+   * chunks; a chunk whose job fails is read again in-process.
+   */
+  std::vector<std::string> readSrcLongnames( Zypper & zypper_r, const std::vector<Pathname> & paths_r, Out::ProgressBar & report_r )
+  {
+    static const unsigned chunkSize = 256;
+    std::vector<std::string> ret( paths_r.size() );
+
+    // Reading the headers is I/O bound (often on NFS), so allow more jobs than CPUs.
+    long cpus = ::sysconf( _SC_NPROCESSORS_ONLN );
+    unsigned jobs = std::min( ( paths_r.size() + chunkSize - 1 ) / chunkSize, (std::size_t)std::max( 4L, 2 * cpus ) );
+    if ( jobs < 2 )
+    {
+      for ( unsigned idx = 0; idx < paths_r.size(); ++idx )
+      {
+	ret[idx] = readSrcLongname( paths_r[idx] );
+	report_r->incr();
+      }
+      return ret;
+    }
+
+    MIL << "Reading " << paths_r.size() << " headers using " << jobs << " jobs" << endl;
+    filesystem::TmpDir tmpdir;
+    ForkPool pool( jobs );
+    for ( unsigned begin = 0; begin < paths_r.size(); begin += chunkSize )
+    {
+      unsigned end = std::min( begin + chunkSize, (unsigned)paths_r.size() );
+      Pathname result( tmpdir.path() / str::numstring( begin ) );
+      pool.submit( [&paths_r,begin,end,result]()->int {
+	std::ofstream out( result.c_str() );
+	for ( unsigned idx = begin; idx < end; ++idx )
+	  out << readSrcLongname( paths_r[idx] ) << '\n';
+	return out.flush() ? 0 : 1;
+      });
+    }
+
+    // merge in job order
+    for ( unsigned job = 0, begin = 0; job < pool.size(); ++job, begin += chunkSize )
+    {
+      unsigned end = std::min( begin + chunkSize, (unsigned)paths_r.size() );
+      ForkPool::Result result( pool.collect( job ) );
+
+      unsigned idx = begin;
+      if ( result.exitCode == 0 )
+      {
+	std::ifstream in( ( tmpdir.path() / str::numstring( begin ) ).c_str() );
+	for ( ; idx < end && std::getline( in, ret[idx] ); ++idx )
+	{;}
+      }
+      if ( idx != end )
+      {
+	WAR << "Header job " << job << " returned " << result.exitCode << ", reading in-process" << endl;
+	for ( idx = begin; idx < end; ++idx )
+	  ret[idx] = readSrcLongname( paths_r[idx] );
+      }
+      report_r->incr( end - begin );
+
+      if ( zypper_r.exitRequested() )
+	throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+    }
+    return ret;
+  }
+
   ///////////////////////////////////////////////////////////////////
   /// class SourceDownloadImpl
   ///////////////////////////////////////////////////////////////////
@@ -235,25 +402,61 @@ namespace
 	return;
       }
 
+      // Files unchanged since the last scan are looked up in the header cache,
+      // the others are read in parallel. Results are merged in directory order.
+      Pathname cachefile( pi.path() / _options->_headerCacheName );
+      HeaderCache cache;
+      cache.read( cachefile );
+
       Out::ProgressBar report( _zypper.out(), _("Scanning download directory") );
       report->range( todolist.size() );
+
+      HeaderCache newcache;
+      std::vector<std::string> files;
+      std::vector<Pathname> toread;
+      std::vector<PathInfo> toreadInfo;
       for ( const auto & file : todolist )
       {
-	report->incr();	// fast enough to count in advance.
-
-	if ( file == _options->_manifestName )
+	if ( file == _options->_manifestName
+	  || file == _options->_headerCacheName
+	  || file == _options->_headerCacheName + ".new" )
+	{
+	  report->incr();
 	  continue;
+	}
+
+	PathInfo fpi( pi.path() / file );
+	auto it( cache._entries.find( file ) );
+	if ( it != cache._entries.end() && it->second.matches( fpi ) )
+	{
+	  newcache._entries[file] = std::move(it->second);
+	  report->incr();
+	}
+	else
+	{
+	  toread.push_back( fpi.path() );
+	  toreadInfo.push_back( fpi );
+	}
+	files.push_back( file );
+      }
+      DBG << "Header cache hits: " << newcache._entries.size() << ", to read: " << toread.size() << endl;
 
-	using target::rpm::RpmHeader;
-	Pathname path( pi.path() / file );
-	RpmHeader::constPtr pkg( RpmHeader::readPackage( path, RpmHeader::NOVERIFY ) );
+      std::vector<std::string> longnames( readSrcLongnames( _zypper, toread, report ) );
+      for ( unsigned idx = 0; idx < toread.size(); ++idx )
+	newcache._entries[toread[idx].basename()] = HeaderCache::Entry( toreadInfo[idx], longnames[idx] );
 
-	if ( ! ( pkg && pkg->isSrc() ) )
+      for ( const auto & file : files )
+      {
+	const std::string & longname( newcache._entries[file].longname );
+	if ( longname.empty() )
 	  continue;
 
-	SourcePkg & spkg( _manifest.get( SourcePkg::makeLongname( pkg->tag_name(), pkg->tag_edition(), pkg->isNosrc() ) ) );
+	SourcePkg & spkg( _manifest.get( longname ) );
 	spkg._localFile = file;
       }
+
+      if ( ! _options->_dryrun && ( ! toread.empty() || newcache._entries.size() != cache._entries.size() ) )
+	newcache.write( cachefile );
     }
 
     // scan installed packages to manifest
@@ -411,70 +614,135 @@ namespace
     if ( status[SourcePkg::S_MISSING] )
     {
       _zypper.out().info(_("Downloading required source packages...") );
+      std::vector<SourcePkg*> missing;
+      for ( auto & item : _manifest )
+      {
+	if ( item.second.status() == SourcePkg::S_MISSING )
+	  missing.push_back( &item.second );
+      }
+
+      if ( _options->_parallel > 1 && missing.size() > 1 )
+	missing = downloadParallel( missing );
+
+      // download the rest (or retry failed parallel downloads) one by one
       repo::RepoMediaAccess access;
       repo::SrcPackageProvider prov( access );
       unsigned current = 0;
-      for ( auto & item : _manifest )
+      for ( SourcePkg * spkg : missing )
       {
-	SourcePkg & spkg( item.second );
-	if ( spkg.status() != SourcePkg::S_MISSING )
-	  continue;
-	++current;
+	downloadSrcPackage( *spkg, prov, ++current, missing.size() );
 
-	try
-	{
-	  Out::ProgressBar report( _zypper.out(), spkg._longname, current, status[SourcePkg::S_MISSING] );
+	if ( _zypper.exitRequested() )
+	  throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+      }
+    }
+    else
+    {
+      _zypper.out().info(_("No source packages to download.") );
+    }
+  }
 
-	  if ( ! spkg.lookupSrcPackage() )
-	  {
-	    report.error();
-	    throw( Out::Error( ZYPPER_EXIT_ERR_BUG,
-			       boost::format(_("Source package '%s' is not provided by any repository.") ) % spkg._longname ) );
-	  }
-	  report.print( str::form( "%s (%s)",  spkg._longname.c_str(), spkg._srcPackage->repository().name().c_str() ) );
-	  MIL << spkg._srcPackage << endl;
+  void SourceDownloadImpl::downloadSrcPackage( SourcePkg & spkg, repo::SrcPackageProvider & prov, unsigned current, unsigned total )
+  {
+    try
+    {
+      Out::ProgressBar report( _zypper.out(), spkg._longname, current, total );
 
-	  ManagedFile localfile;
-	  {
-	    report.error(); // error if provideSrcPackage throws
-	    Out::DownloadProgress redirect( report );
-	    localfile = prov.provideSrcPackage( spkg._srcPackage->asKind<SrcPackage>() );
-	    DBG << localfile << endl;
-	    report.error( false );
-	  }
+      if ( ! spkg.lookupSrcPackage() )
+      {
+	report.error();
+	throw( Out::Error( ZYPPER_EXIT_ERR_BUG,
+			   boost::format(_("Source package '%s' is not provided by any repository.") ) % spkg._longname ) );
+      }
+      report.print( str::form( "%s (%s)",  spkg._longname.c_str(), spkg._srcPackage->repository().name().c_str() ) );
+      MIL << spkg._srcPackage << endl;
 
-	  if ( filesystem::hardlinkCopy( localfile, _dnlDir / (spkg._longname+".rpm") ) != 0 )
-	  {
-	    ERR << "Can't hardlink/copy " << localfile << " to " <<  (_dnlDir / spkg._longname) << endl;
-	    report.error();
-	    throw( Out::Error( ZYPPER_EXIT_ERR_BUG,
-			       boost::format(_("Error downloading source package '%s'.") ) % spkg._longname ),
-			       Errno().asString() );
-	  }
-	  spkg._localFile = spkg._longname;
-	}
-	catch ( const Out::Error & error_r )
-	{
-	  error_r.report( _zypper );
-	}
-	catch ( const Exception & exp )
-	{
-	  // TODO: Need class Out::Error support for exceptions
-	  ERR << exp << endl;
-	  _zypper.out().error( exp,
-			       boost::str( boost::format(_("Error downloading source package '%s'.") ) % spkg._longname ) );
+      ManagedFile localfile;
+      {
+	report.error(); // error if provideSrcPackage throws
+	Out::DownloadProgress redirect( report );
+	localfile = prov.provideSrcPackage( spkg._srcPackage->asKind<SrcPackage>() );
+	DBG << localfile << endl;
+	report.error( false );
+      }
 
-	  //throw( Out::Error( ZYPPER_EXIT_ERR_BUG ) );
-	}
+      if ( filesystem::hardlinkCopy( localfile, _dnlDir / (spkg._longname+".rpm") ) != 0 )
+      {
+	ERR << "Can't hardlink/copy " << localfile << " to " <<  (_dnlDir / spkg._longname) << endl;
+	report.error();
+	throw( Out::Error( ZYPPER_EXIT_ERR_BUG,
+			   boost::format(_("Error downloading source package '%s'.") ) % spkg._longname ),
+			   Errno().asString() );
+      }
+      spkg._localFile = spkg._longname;
+    }
+    catch ( const Out::Error & error_r )
+    {
+      error_r.report( _zypper );
+    }
+    catch ( const Exception & exp )
+    {
+      // TODO: Need class Out::Error support for exceptions
+      ERR << exp << endl;
+      _zypper.out().error( exp,
+			   boost::str( boost::format(_("Error downloading source package '%s'.") ) % spkg._longname ) );
 
-	if ( _zypper.exitRequested() )
-	  throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
+      //throw( Out::Error( ZYPPER_EXIT_ERR_BUG ) );
+    }
+  }
+
+  std::vector<SourceDownloadImpl::SourcePkg*> SourceDownloadImpl::downloadParallel( const std::vector<SourcePkg*> & missing )
+  {
+    MIL << "going to download " << missing.size() << " source packages using " << _options->_parallel << " jobs" << endl;
+    std::vector<SourcePkg*> failed;
+
+    Out::ProgressBar report( _zypper.out(), _("Downloading source packages") );
+    report->range( missing.size() );
+
+    // Jobs are run non-interactive and quietly. Whatever fails is
+    // retried one by one afterwards, reporting the error the usual way.
+    std::vector<SourcePkg*> submitted;
+    ForkPool pool( _options->_parallel );
+    for ( SourcePkg * spkg : missing )
+    {
+      if ( ! spkg->lookupSrcPackage() )
+      {
+	failed.push_back( spkg );	// to be reported below
+	report->incr();
+	continue;
       }
+      Pathname target( _dnlDir / (spkg->_longname+".rpm") );
+      SrcPackage::constPtr srcpkg( spkg->_srcPackage->asKind<SrcPackage>() );
+      pool.submit( [this,srcpkg,target]()->int {
+	_zypper.globalOptsNoConst().non_interactive = true;
+	repo::RepoMediaAccess access;
+	repo::SrcPackageProvider prov( access );
+	ManagedFile localfile( prov.provideSrcPackage( srcpkg ) );
+	return filesystem::hardlinkCopy( localfile, target ) == 0 ? 0 : 1;
+      });
+      submitted.push_back( spkg );
     }
-    else
+
+    for ( unsigned idx = 0; idx < pool.size(); ++idx )
     {
-      _zypper.out().info(_("No source packages to download.") );
+      SourcePkg & spkg( *submitted[idx] );
+      ForkPool::Result result( pool.collect( idx ) );
+      if ( result.exitCode == 0 && PathInfo( _dnlDir / (spkg._longname+".rpm") ).isFile() )
+      {
+	MIL << "Downloaded " << spkg._srcPackage << endl;
+	spkg._localFile = spkg._longname;
+      }
+      else
+      {
+	MIL << "download job for " << spkg._longname << " returned " << result.exitCode << ", retrying in-process" << endl;
+	failed.push_back( &spkg );
+      }
+      report->incr();
+
+      if ( _zypper.exitRequested() )
+	throw( Out::Error( ZYPPER_EXIT_ON_SIGNAL ) );
     }
+    return failed;
   }
 
 } // namespace
@@ -36,6 +36,7 @@ struct SourceDownloadOptions : public Options
 {
   static const Pathname _defaultDirectory;
   static const std::string _manifestName;
+  static const std::string _headerCacheName;
 
   SourceDownloadOptions()
     : Options( ZypperCommand::SOURCE_DOWNLOAD )
@@ -43,12 +44,14 @@ struct SourceDownloadOptions : public Options
 //     , _manifest( true )
     , _delete( true )
     , _dryrun( false )
+    , _parallel( 1 )
   {}
 
   Pathname _directory;	//< Download all source rpms to this directory.
 //   int _manifest;	//< Whether to write a MANIFEST file.
   int _delete;		//< Whether to delete extranous source rpms.
   int _dryrun;		//< Dryrun mode.
+  unsigned _parallel;	//< Number of source packages to download at once.
 };
 
 /** Download source rpms for all installed packages to a local directory.
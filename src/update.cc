@@ -10,7 +10,9 @@
 #include <zypp/Patch.h>
 
 #include "SolverRequester.h"
+#include "IssueIndex.h"
 #include "Table.h"
+#include "utils/SubstringMatcher.h"
 #include "update.h"
 #include "main.h"
 
@@ -363,7 +365,7 @@ static bool list_patch_updates( Zypper & zypper )
       zypper.out().info("", Out::NORMAL, Out::TYPE_NORMAL);
     }
     pm_tbl.sort(1); // Name
-    cout << pm_tbl;
+    zypper.out().table( pm_tbl );
   }
 
   tbl.sort(1); // Name
@@ -377,7 +379,7 @@ static bool list_patch_updates( Zypper & zypper )
       zypper.out().info(_("The following updates are also available:"));
     }
     zypper.out().info("", Out::QUIET, Out::TYPE_NORMAL);
-    cout << tbl;
+    zypper.out().table( tbl );
   }
 
   return affectpm;
@@ -598,7 +600,7 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort)
     if (tbl.empty())
       zypper.out().info(_("No updates found."));
     else
-      cout << tbl;
+      zypper.out().table( tbl );
   }
 }
 
@@ -615,100 +617,117 @@ void list_patches_by_issue( Zypper & zypper )
   CliMatchPatch cliMatchPatch( zypper );
   bool only_needed = !zypper.cOpts().count("all");
 
-  // Basic PoolQuery tuned for each argument
-  PoolQuery basicQ;
-  basicQ.setMatchSubstring();
-  basicQ.setCaseSensitive( false );
-  basicQ.addKind( ResKind::patch );
-
-  std::vector<const Issue*> pass2; // on the fly remember anyType issues for pass2
-
+  // All issues are looked up in a single pass over the patches, instead of
+  // a PoolQuery per issue. Issue IDs are case insensitive substring matches
+  // (like the PoolQuery used to do), so all of them are matched at once by a
+  // SubstringMatcher.
+  std::vector<const Issue*> idIssues;	// matched against the reference IDs
+  std::vector<std::string> ids;
+  std::set<std::string> anyIdTypes;	// specificType && anyId: all references of this type
+  bool anyTypeIssues = false;
   for ( const Issue & issue : issues )
   {
     DBG << "querying: " << issue.type() << " = " << issue.id() << endl;
-    PoolQuery q( basicQ );
-    // PoolQuery ORs attributes but we need AND.
-    // Post processing the match must assert correct type of specific IDs!
     if ( issue.specificType() && issue.anyId() )
-    { q.addAttribute(sat::SolvAttr::updateReferenceType, issue.type() ); }
+      anyIdTypes.insert( issue.type() );
     else
     {
-      q.addAttribute( sat::SolvAttr::updateReferenceId, issue.id() );
-      if ( issue.anyType() && issue.specificId() ) 				// remember for pass2
-      {
-	q.addAttribute( sat::SolvAttr::updateReferenceType, issue.id() );	// bnc#941309: let '--issue-bugzilla' also match the type
-	pass2.push_back( &issue );
-      }
+      idIssues.push_back( &issue );
+      ids.push_back( issue.id() );
+      if ( issue.anyType() && issue.specificId() )
+	anyTypeIssues = true;	// bnc#941309: let '--issue-bugzilla' also match the type; pass2
     }
+  }
+  SubstringMatcher idMatcher( ids );
 
-    for_( it, q.begin(), q.end() )
-    {
-      PoolItem pi( *it );
-      Patch::constPtr patch = asKind<Patch>(pi);
+  // pass2: matches in patch summary/description
+  Table t1;
+  t1 << ( TableHeader() << _("Name") << _("Category") << _("Severity") << _("Interactive") << _("Summary") );
 
-      if ( only_needed && ( !pi.isBroken() || pi.isUnwanted() ) )
-	continue;
+  std::vector<unsigned> idMatches;
+  std::vector<unsigned> typeMatches;
+  for_( it, God->pool().byKindBegin<Patch>(), God->pool().byKindEnd<Patch>() )
+  {
+    const PoolItem & pi( *it );
+    if ( only_needed && ( !pi.isBroken() || pi.isUnwanted() ) )
+      continue;
 
-      if ( ! cliMatchPatch( patch ) )
+    Patch::constPtr patch = asKind<Patch>(pi);
+    TriBool cliMatched = indeterminate;	// checked on the first match only
+    auto cliMatches = [&]()->bool
+    {
+      if ( indeterminate( cliMatched ) )
       {
-	DBG << patch->ident() << " skipped. (not matching CLI filter)" << endl;
-	continue;
+	cliMatched = cliMatchPatch( patch );
+	if ( ! cliMatched )
+	  DBG << patch->ident() << " skipped. (not matching CLI filter)" << endl;
       }
+      return bool( cliMatched );
+    };
 
-      // Print details about each match in that solvable:
-      for_( d, it.matchesBegin(), it.matchesEnd() )
+    for_( ref, patch->referencesBegin(), patch->referencesEnd() )
+    {
+      const std::string & itype( ref.type() );
+      bool matched = anyIdTypes.count( itype );
+
+      idMatches.clear();
+      idMatcher.find( ref.id(), idMatches );
+      if ( anyTypeIssues )
       {
-        const std::string & itype = d->subFind( sat::SolvAttr::updateReferenceType ).asString();
-
-	if ( issue.specificType() && itype != issue.type() )
-	  continue;	// assert correct type of specific IDs
-
-	t << ( TableRow()
-	  << itype
-	  << d->subFind( sat::SolvAttr::updateReferenceId ).asString()
-	  << patch->name()
-	  << patchHighlight(patch->category())
-	  << patchHighlight(patch->severity())
-	  << interactiveFlags(*patch)
-	  << (pi.isBroken() ? _("needed") : _("not needed")) );
+	typeMatches.clear();
+	idMatcher.find( itype, typeMatches );
+	for ( unsigned idx : typeMatches )
+	{
+	  if ( idIssues[idx]->anyType() )
+	    idMatches.push_back( idx );
+	}
+      }
+      for ( unsigned idx : idMatches )
+      {
+	const Issue & issue( *idIssues[idx] );
+	if ( issue.anyType() || itype == issue.type() )	// assert correct type of specific IDs
+	  matched = true;
       }
-    }
-  }
 
-  // pass2: look for matches in patch summary/description
-  //
-  Table t1;
-  t1 << ( TableHeader() << _("Name") << _("Category") << _("Severity") << _("Interactive") << _("Summary") );
+      if ( ! matched || ! cliMatches() )
+	continue;
 
-  for ( const Issue* _issue : pass2 )
-  {
-    const Issue & issue( *_issue );
-    PoolQuery q( basicQ );
-    q.addAttribute(sat::SolvAttr::summary, issue.id() );
-    q.addAttribute(sat::SolvAttr::description, issue.id() );
+      t << ( TableRow()
+	<< itype
+	<< ref.id()
+	<< patch->name()
+	<< patchHighlight(patch->category())
+	<< patchHighlight(patch->severity())
+	<< interactiveFlags(*patch)
+	<< (pi.isBroken() ? _("needed") : _("not needed")) );
+    }
 
-    for_( it, q.begin(), q.end() )
+    if ( anyTypeIssues )
     {
-      PoolItem pi( *it );
-      Patch::constPtr patch = asKind<Patch>(pi);
-
-      if ( only_needed && ( !pi.isBroken() || pi.isUnwanted() ) )
-	continue;
-
-      if ( ! cliMatchPatch( patch ) )
+      idMatches.clear();
+      idMatcher.find( patch->summary(), idMatches );
+      idMatcher.find( patch->description(), idMatches );
+      bool matched = false;
+      for ( unsigned idx : idMatches )
       {
-	DBG << patch->ident() << " skipped. (not matching CLI filter)" << endl;
-	continue;
+	const Issue & issue( *idIssues[idx] );
+	if ( issue.anyType() && issue.specificId() )
+	{
+	  matched = true;
+	  break;
+	}
+      }
+      if ( matched && cliMatches() )
+      {
+	t1 << ( TableRow()
+	   << patch->name()
+	   << patchHighlight(patch->category())
+	   << patchHighlight(patch->severity())
+	   << interactiveFlags(*patch)
+	   << patch->summary() );
+	//! \todo could show a highlighted match with a portion of surrounding
+	//! text. Needs case-insensitive find.
       }
-
-      t1 << ( TableRow()
-         << patch->name()
-	 << patchHighlight(patch->category())
-	 << patchHighlight(patch->severity())
-	 << interactiveFlags(*patch)
-	 << patch->summary() );
-      //! \todo could show a highlighted match with a portion of surrounding
-      //! text. Needs case-insensitive find.
     }
   }
 
@@ -724,20 +743,22 @@ void list_patches_by_issue( Zypper & zypper )
   {
     if ( !t.empty() )
     {
-      if ( !pass2.empty() )
+      if ( anyTypeIssues )
       {
-        cout << endl;
+        zypper.out().info("", Out::NORMAL, Out::TYPE_NORMAL);
         zypper.out().info(_("The following matches in issue numbers have been found:"));
       }
-      cout << endl << t;
+      zypper.out().info("", Out::QUIET, Out::TYPE_NORMAL);
+      zypper.out().table( t );
     }
 
     if ( !t1.empty() )
     {
       if ( !t.empty() )
-      { cout << endl; }
+      { zypper.out().info("", Out::NORMAL, Out::TYPE_NORMAL); }
       zypper.out().info(_( "Matches in patch descriptions of the following patches have been found:"));
-      cout << endl << t1;
+      zypper.out().info("", Out::QUIET, Out::TYPE_NORMAL);
+      zypper.out().table( t1 );
     }
   }
 }
@@ -748,55 +769,39 @@ void mark_updates_by_issue( Zypper & zypper )
 {
   CliScanIssues issues;
 
-  // Basic PoolQuery tuned for each argument
-  PoolQuery basicQ;
-  basicQ.setMatchExact();
-  basicQ.setCaseSensitive( false );
-  basicQ.addKind( ResKind::patch );
+  // All update references are indexed once, instead of a PoolQuery per issue.
+  IssueIndex index;
 
   SolverRequester::Options srOpts;
   srOpts.force = zypper.cOpts().count("force");
   srOpts.skip_interactive = zypper.cOpts().count("skip-interactive");
   srOpts.cliMatchPatch = CliMatchPatch( zypper );
 
+  std::vector<sat::Solvable> patches;
   for ( const Issue & issue : issues )
   {
-    PoolQuery q( basicQ );
-    // PoolQuery ORs attributes but we need AND.
-    // Post processing the match must assert correct type of specific IDs!
-    if ( issue.specificType() && issue.anyId() )
-    { q.addAttribute(sat::SolvAttr::updateReferenceType, issue.type() ); }
-    else
-    { q.addAttribute( sat::SolvAttr::updateReferenceId, issue.id() ); }
+    patches.clear();
+    index.find( issue.type(), issue.id(), patches );
 
     SolverRequester sr( srOpts );
     bool found = false;
 
-    for_( it, q.begin(), q.end() )
+    for ( const sat::Solvable & solv : patches )
     {
-      PoolItem pi( *it );
-      Patch::constPtr patch = asKind<Patch>(pi);
+      PoolItem pi( solv );
 
       if ( !pi.isBroken() ) // not needed
 	continue;
 
       // CliMatchPatch not needed, it's fed into srOpts!
 
-      DBG << "got: " << *it << endl;
+      DBG << "got: " << pi << endl;
 
-      for_( d, it.matchesBegin(), it.matchesEnd() )
-      {
-	const std::string & itype = d->subFind( sat::SolvAttr::updateReferenceType ).asString();
-
-	if ( issue.specificType() && itype != issue.type() )
-	  continue;	// assert correct type of specific IDs
-
-	if ( sr.installPatch( pi ) )
-	  found = true;
-	else
-	  DBG << str::form("fix for %s issue number %s was not marked.",
-			   issue.type().c_str(), issue.id().c_str() );
-      }
+      if ( sr.installPatch( pi ) )
+	found = true;
+      else
+	DBG << str::form("fix for %s issue number %s was not marked.",
+			 issue.type().c_str(), issue.id().c_str() );
     }
 
     sr.printFeedback( zypper.out() );
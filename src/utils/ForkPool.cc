@@ -0,0 +1,263 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <zypp/base/Logger.h>
+
+#include "utils/ForkPool.h"
+
+// libzypp logger settings
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypper"
+
+using std::endl;
+
+ForkPool::ForkPool( unsigned maxJobs_r )
+: _maxJobs( maxJobs_r ? maxJobs_r : 1 )
+, _running( 0 )
+, _nextQueued( 0 )
+{}
+
+ForkPool::~ForkPool()
+{
+  for ( Slot & slot : _jobs )
+  {
+    if ( slot.pid > 0 )
+    {
+      WAR << "Terminating job " << slot.pid << endl;
+      ::kill( slot.pid, SIGTERM );
+      reap( slot, true );
+    }
+    if ( slot.fd >= 0 )
+      ::close( slot.fd );
+  }
+}
+
+unsigned ForkPool::submit( Job job_r )
+{
+  _jobs.push_back( Slot( std::move(job_r) ) );
+  reapAll();
+  startQueued();
+  return _jobs.size() - 1;
+}
+
+ForkPool::Result ForkPool::collect( unsigned idx_r )
+{
+  Result ret;
+  if ( idx_r >= _jobs.size() || _jobs[idx_r].collected )
+    return ret;
+
+  reapAll();
+  startQueued();
+
+  Slot & slot( _jobs[idx_r] );
+  while ( ! slot.done )
+  {
+    if ( slot.pid > 0 )
+      reap( slot, true );
+    else
+    {
+      // still queued: wait for the oldest running job to free a slot
+      for ( Slot & other : _jobs )
+      {
+	if ( other.pid > 0 )
+	{
+	  reap( other, true );
+	  break;
+	}
+      }
+    }
+    startQueued();
+  }
+
+  if ( slot.fd >= 0 )
+  {
+    ::lseek( slot.fd, 0, SEEK_SET );
+    char buf[4096];
+    ssize_t n;
+    while ( ( n = ::read( slot.fd, buf, sizeof(buf) ) ) != 0 )
+    {
+      if ( n > 0 )
+	slot.result.output.append( buf, n );
+      else if ( errno != EINTR )
+	break;
+    }
+    ::close( slot.fd );
+    slot.fd = -1;
+  }
+
+  slot.collected = true;
+  slot.job = Job();	// release anything bound to the job
+  std::swap( ret, slot.result );
+  return ret;
+}
+
+bool ForkPool::done( unsigned idx_r )
+{
+  if ( idx_r >= _jobs.size() )
+    return true;
+
+  reapAll();
+  startQueued();
+  return _jobs[idx_r].done;
+}
+
+void ForkPool::wait()
+{
+  if ( _running )
+  {
+    // block until any child exits, but leave reaping it to reap()
+    siginfo_t info;
+    info.si_pid = 0;
+    while ( ::waitid( P_ALL, 0, &info, WEXITED|WNOWAIT ) < 0 && errno == EINTR )
+    {;} // just loop
+
+    Slot * oldest = nullptr;
+    Slot * exited = nullptr;
+    for ( Slot & slot : _jobs )
+    {
+      if ( slot.pid > 0 )
+      {
+	if ( ! oldest )
+	  oldest = &slot;
+	if ( slot.pid == info.si_pid )
+	{
+	  exited = &slot;
+	  break;
+	}
+      }
+    }
+    // not one of ours (or waitid failed): wait for the oldest job
+    reap( exited ? *exited : *oldest, true );
+  }
+  startQueued();
+}
+
+void ForkPool::startQueued()
+{
+  while ( _running < _maxJobs && _nextQueued < _jobs.size() )
+    start( _jobs[_nextQueued++] );
+}
+
+void ForkPool::start( Slot & slot_r )
+{
+  FILE * tmp = ::tmpfile();
+  if ( tmp )
+  {
+    slot_r.fd = ::dup( ::fileno( tmp ) );
+    ::fclose( tmp );	// slot_r.fd keeps the (already unlinked) file open
+  }
+  if ( slot_r.fd < 0 )
+  {
+    ERR << "Can't create job output file: " << ::strerror( errno ) << endl;
+    slot_r.result.output = ::strerror( errno );
+    slot_r.done = true;
+    return;
+  }
+
+  // don't let the child replay any buffered output
+  std::cout.flush();
+  std::cerr.flush();
+  ::fflush( nullptr );
+
+  pid_t pid = ::fork();
+  if ( pid == 0 )
+  {
+    //////////////////////////////////////////////////////////////////////
+    int devnull = ::open( "/dev/null", O_RDONLY );
+    if ( devnull >= 0 )
+    {
+      ::dup2( devnull, 0 );
+      ::close( devnull );
+    }
+    ::dup2( slot_r.fd, 1 );
+    ::dup2( slot_r.fd, 2 );
+    ::close( slot_r.fd );
+
+    int ret = 1;
+    try
+    {
+      ret = slot_r.job();
+    }
+    catch ( const std::exception & excpt_r )
+    {
+      std::cerr << excpt_r.what() << endl;
+    }
+    catch ( ... )
+    {}
+
+    std::cout.flush();
+    std::cerr.flush();
+    ::fflush( nullptr );
+    // No destructors, no atexit handlers! They belong to the parent.
+    ::_exit( ret );
+    //////////////////////////////////////////////////////////////////////
+  }
+  else if ( pid < 0 )
+  {
+    ERR << "fork failed: " << ::strerror( errno ) << endl;
+    slot_r.result.output = ::strerror( errno );
+    slot_r.done = true;
+    return;
+  }
+
+  DBG << "Started job " << pid << endl;
+  slot_r.pid = pid;
+  ++_running;
+}
+
+bool ForkPool::reap( Slot & slot_r, bool block_r )
+{
+  if ( slot_r.pid <= 0 )
+    return slot_r.done;
+
+  int status = 0;
+  pid_t code;
+  while ( ( code = ::waitpid( slot_r.pid, &status, block_r ? 0 : WNOHANG ) ) < 0 && errno == EINTR )
+  {;} // just loop
+
+  if ( code == 0 )
+    return false;	// still running
+
+  if ( code < 0 )
+  {
+    ERR << "waitpid for job " << slot_r.pid << " failed: " << ::strerror( errno ) << endl;
+    slot_r.result.exitCode = -1;
+  }
+  else if ( WIFSIGNALED(status) )
+  {
+    WAR << "Job " << slot_r.pid << " was killed by signal " << WTERMSIG(status) << endl;
+    slot_r.result.exitCode = 128 + WTERMSIG(status);
+  }
+  else if ( WIFEXITED(status) )
+  {
+    DBG << "Job " << slot_r.pid << " exited with status " << WEXITSTATUS(status) << endl;
+    slot_r.result.exitCode = WEXITSTATUS(status);
+  }
+
+  slot_r.pid = -1;
+  slot_r.done = true;
+  --_running;
+  return true;
+}
+
+void ForkPool::reapAll()
+{
+  for ( Slot & slot : _jobs )
+  {
+    if ( slot.pid > 0 )
+      reap( slot, false );
+  }
+}
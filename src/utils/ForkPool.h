@@ -0,0 +1,123 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_UTILS_FORKPOOL_H_
+#define ZYPPER_UTILS_FORKPOOL_H_
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <sys/types.h>
+
+#include <zypp/base/NonCopyable.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class ForkPool
+/// \brief Run jobs in up to \ref maxJobs forked child processes.
+///
+/// libzypp is not threadsafe. Jobs which spend most of their time
+/// waiting for the network (like downloading metadata or packages)
+/// are therefore run in a forked copy of the current process. The
+/// child inherits the loaded pool, RepoManager, etc. but it can not
+/// pass any changes back to the parent, except via the filesystem.
+///
+/// A jobs stdout and stderr are collected in a temp file, stdin is
+/// redirected from /dev/null. The output is passed to the parent when
+/// the job is \ref collect ed, so it can be replayed in job order.
+///
+/// \code
+///   ForkPool pool( 4 );
+///   for ( const auto & repo : repos )
+///     pool.submit( [&]()->int { return download( repo ); } );
+///
+///   for ( unsigned idx = 0; idx < pool.size(); ++idx )
+///   {
+///     ForkPool::Result res( pool.collect( idx ) );
+///     cout << res.output;
+///   }
+/// \endcode
+///
+/// \note Jobs are started in submit order as soon as a slot is free.
+/// Finished jobs are reaped whenever the pool is used, so \ref collect
+/// for a job will not delay starting the queued ones.
+///////////////////////////////////////////////////////////////////
+class ForkPool : private zypp::base::NonCopyable
+{
+public:
+  /** The job to run in the child. Its return value is the childs exit code. */
+  typedef std::function<int()> Job;
+
+  /** A finished jobs exit code and output. */
+  struct Result
+  {
+    Result() : exitCode( -1 ) {}
+    /** The jobs return value; \c 128+signal if it was killed, \c -1 if it could not be run at all. */
+    int exitCode;
+    /** The jobs stdout/stderr. */
+    std::string output;
+  };
+
+public:
+  /** Ctor: run at most \a maxJobs_r jobs at once (at least 1). */
+  explicit ForkPool( unsigned maxJobs_r );
+
+  /** Dtor: Running jobs are terminated. */
+  ~ForkPool();
+
+  /** Max. number of jobs running at once. */
+  unsigned maxJobs() const
+  { return _maxJobs; }
+
+  /** Number of submitted jobs. */
+  unsigned size() const
+  { return _jobs.size(); }
+
+  /** Enqueue \a job_r and return its index. It is started as soon as a slot is free. */
+  unsigned submit( Job job_r );
+
+  /** Wait for job \a idx_r to finish and return its \ref Result.
+   * A job can be collected only once. Subsequent calls return an
+   * empty \ref Result.
+   */
+  Result collect( unsigned idx_r );
+
+  /** Whether job \a idx_r has finished (does not wait). */
+  bool done( unsigned idx_r );
+
+  /** Wait for any running job to finish (if any) and start the next queued one. */
+  void wait();
+
+private:
+  /** Housekeeping data per job. */
+  struct Slot
+  {
+    Slot( Job job_r ) : job( std::move(job_r) ), pid( -1 ), fd( -1 ), done( false ), collected( false ) {}
+    Job    job;
+    pid_t  pid;		///< Child pid while running, else -1.
+    int    fd;		///< Temp file collecting the output.
+    bool   done;		///< Child was reaped or could not be started.
+    bool   collected;	///< Result was passed to the caller.
+    Result result;
+  };
+
+  /** Start queued jobs while there are free slots. */
+  void startQueued();
+  /** Fork the child for \a slot_r. */
+  void start( Slot & slot_r );
+  /** Reap \a slot_r if it's done; wait for it if \a block_r. */
+  bool reap( Slot & slot_r, bool block_r );
+  /** Reap all jobs that are done (nonblocking). */
+  void reapAll();
+
+private:
+  unsigned _maxJobs;
+  unsigned _running;
+  unsigned _nextQueued;
+  std::vector<Slot> _jobs;
+};
+
+#endif /* ZYPPER_UTILS_FORKPOOL_H_ */
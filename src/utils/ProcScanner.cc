@@ -0,0 +1,208 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <map>
+#include <cstring>
+#include <cerrno>
+#include <dirent.h>
+#include <pwd.h>
+#include <sys/stat.h>
+
+#include <zypp/base/Logger.h>
+
+#include "utils/ProcScanner.h"
+
+// libzypp logger settings
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypper"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Min. number of PIDs per worker thread. */
+  const unsigned minPidsPerThread = 128;
+
+  inline bool startsWith( const std::string & str_r, std::string::size_type pos_r, const char * prefix_r )
+  { return str_r.compare( pos_r, ::strlen( prefix_r ), prefix_r ) == 0; }
+
+  /** The numeric entries in \c /proc, sorted. */
+  std::vector<unsigned> readPids()
+  {
+    std::vector<unsigned> ret;
+    DIR * dir = ::opendir( "/proc" );
+    if ( ! dir )
+    {
+      ERR << "Can't read /proc: " << ::strerror( errno ) << endl;
+      return ret;
+    }
+    while ( struct dirent * ent = ::readdir( dir ) )
+    {
+      char * end = nullptr;
+      unsigned long pid = ::strtoul( ent->d_name, &end, 10 );
+      if ( *ent->d_name && ! *end )
+	ret.push_back( pid );
+    }
+    ::closedir( dir );
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+  }
+
+  /** Scan a single process, append it to \a result_r if it uses deleted files. */
+  void scanPid( unsigned pid_r, const ProcScanner::FileSet * files_r, ProcScanner::ProcInfoList & result_r )
+  {
+    const std::string procDir( "/proc/" + std::to_string( pid_r ) );
+
+    std::vector<std::string> files;
+    {
+      std::ifstream maps( procDir + "/maps" );
+      std::string line;
+      std::string file;
+      while ( std::getline( maps, line ) )
+      {
+	if ( ProcScanner::deletedFileInMapsLine( line, file ) && ( ! files_r || files_r->count( file ) ) )
+	  files.push_back( std::move(file) );
+      }
+    }
+    if ( files.empty() )
+      return;	// vanished, not permitted or nothing deleted
+
+    // a file is usually mapped more than once
+    std::sort( files.begin(), files.end() );
+    files.erase( std::unique( files.begin(), files.end() ), files.end() );
+
+    ProcScanner::ProcInfo procInfo;
+    procInfo.pid = std::to_string( pid_r );
+    procInfo.files.swap( files );
+
+    struct stat st;
+    if ( ::stat( procDir.c_str(), &st ) == 0 )
+      procInfo.puid = std::to_string( st.st_uid );
+
+    {
+      // "pid (comm) state ppid ...", comm may contain blanks and parens
+      std::ifstream statFile( procDir + "/stat" );
+      std::string line;
+      std::getline( statFile, line );
+      std::string::size_type pos = line.rfind( ')' );
+      if ( pos != std::string::npos )
+      {
+	pos = line.find( ' ', pos + 2 );	// skip ") S"
+	if ( pos != std::string::npos )
+	{
+	  ++pos;
+	  procInfo.ppid = line.substr( pos, line.find( ' ', pos ) - pos );
+	}
+      }
+    }
+    {
+      std::ifstream comm( procDir + "/comm" );
+      std::getline( comm, procInfo.command );
+    }
+
+    result_r.push_back( std::move(procInfo) );
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+ProcScanner::ProcScanner( unsigned threads_r )
+: _threads( threads_r )
+{
+  if ( ! _threads )
+    _threads = std::max( std::thread::hardware_concurrency(), 1U );
+}
+
+bool ProcScanner::deletedFileInMapsLine( const std::string & line_r, std::string & file_r )
+{
+  // "address perms offset dev inode   pathname"
+  static const std::string deleted( " (deleted)" );
+  if ( line_r.size() <= deleted.size()
+    || line_r.compare( line_r.size() - deleted.size(), deleted.size(), deleted ) != 0 )
+    return false;
+
+  std::string::size_type pos = 0;
+  for ( unsigned field = 0; field < 5; ++field )
+  {
+    pos = line_r.find_first_not_of( ' ', pos );
+    if ( pos == std::string::npos )
+      return false;
+    if ( field == 4 && line_r.compare( pos, 2, "0 " ) == 0 )
+      return false;	// no inode
+    pos = line_r.find( ' ', pos );
+    if ( pos == std::string::npos )
+      return false;
+  }
+  pos = line_r.find_first_not_of( ' ', pos );
+  if ( pos == std::string::npos || line_r[pos] != '/' )
+    return false;
+
+  // Not regular files, but shared memory and the like
+  if ( startsWith( line_r, pos, "/dev/" )
+    || startsWith( line_r, pos, "/SYSV" )
+    || startsWith( line_r, pos, "/memfd:" )
+    || startsWith( line_r, pos, "/[aio]" ) )
+    return false;
+
+  file_r.assign( line_r, pos, line_r.size() - deleted.size() - pos );
+  return true;
+}
+
+const ProcScanner::ProcInfoList & ProcScanner::scan( const FileSet * files_r )
+{
+  _result.clear();
+
+  std::vector<unsigned> pids( readPids() );
+  unsigned shards = std::max( std::min<unsigned>( _threads, pids.size() / minPidsPerThread ), 1U );
+  MIL << "Scanning " << pids.size() << " processes using " << shards << " thread(s)"
+      << ( files_r ? " for " + std::to_string( files_r->size() ) + " files" : "" ) << endl;
+
+  // Contiguous shards of the sorted PIDs, so the concatenated results are sorted too.
+  std::vector<ProcInfoList> results( shards );
+  auto worker = [&]( unsigned shard_r ) {
+    size_t begin = pids.size() * shard_r / shards;
+    size_t end = pids.size() * ( shard_r + 1 ) / shards;
+    for ( size_t idx = begin; idx < end; ++idx )
+      scanPid( pids[idx], files_r, results[shard_r] );
+  };
+
+  std::vector<std::thread> workers;
+  for ( unsigned shard = 1; shard < shards; ++shard )
+    workers.emplace_back( worker, shard );
+  worker( 0 );
+  for ( auto & thread : workers )
+    thread.join();
+
+  // getpwuid is not threadsafe
+  std::map<std::string,std::string> logins;
+  for ( auto & result : results )
+  {
+    for ( auto & procInfo : result )
+    {
+      auto it = logins.find( procInfo.puid );
+      if ( it == logins.end() )
+      {
+	std::string login;
+	if ( ! procInfo.puid.empty() )
+	{
+	  struct passwd * pw = ::getpwuid( std::stoul( procInfo.puid ) );
+	  if ( pw )
+	    login = pw->pw_name;
+	}
+	it = logins.insert( std::make_pair( procInfo.puid, login ) ).first;
+      }
+      procInfo.login = it->second;
+      _result.push_back( std::move(procInfo) );
+    }
+  }
+
+  MIL << _result.size() << " processes use deleted files" << endl;
+  return _result;
+}
@@ -0,0 +1,75 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_UTILS_PROCSCANNER_H_
+#define ZYPPER_UTILS_PROCSCANNER_H_
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include <zypp/misc/CheckAccessDeleted.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class ProcScanner
+/// \brief Find running processes using deleted files by reading \c /proc.
+///
+/// A replacement for \ref zypp::CheckAccessDeleted::check, which walks
+/// all processes one after the other. The PIDs in \c /proc are split
+/// into contiguous shards which are scanned by \ref threads worker
+/// threads. The workers do plain POSIX reads only, libzypp is not used
+/// until the results are merged, so this is safe although libzypp is
+/// not threadsafe.
+///
+/// The result is sorted by PID and uses libzypps \c ProcInfo, so
+/// \c ProcInfo::service still works.
+///
+/// \code
+///   ProcScanner scanner;
+///   for ( const auto & procInfo : scanner.scan() )
+///     cout << procInfo.pid << " " << procInfo.command << endl;
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class ProcScanner
+{
+public:
+  typedef zypp::CheckAccessDeleted::ProcInfo ProcInfo;
+  typedef std::vector<ProcInfo> ProcInfoList;
+  typedef std::unordered_set<std::string> FileSet;
+
+public:
+  /** Ctor: scan using \a threads_r threads (\c 0: one per CPU). */
+  ProcScanner( unsigned threads_r = 0 );
+
+  /** Number of worker threads used. */
+  unsigned threads() const
+  { return _threads; }
+
+  /** Scan all processes for mapped deleted files.
+   * If \a files_r is not \c NULL, only files contained in
+   * \a files_r are reported. Processes without any reported
+   * file are omitted.
+   */
+  const ProcInfoList & scan( const FileSet * files_r = nullptr );
+
+  /** The result of the last \ref scan. */
+  const ProcInfoList & result() const
+  { return _result; }
+
+public:
+  /** Whether a \c /proc/PID/maps line refers to a deleted file worth reporting.
+   * If so, the files name (without the <tt>" (deleted)"</tt> suffix) is
+   * stored in \a file_r. Shared memory, devices and the like are ignored.
+   */
+  static bool deletedFileInMapsLine( const std::string & line_r, std::string & file_r );
+
+private:
+  unsigned _threads;
+  ProcInfoList _result;
+};
+
+#endif // ZYPPER_UTILS_PROCSCANNER_H_
@@ -0,0 +1,120 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+#include <deque>
+
+#include "utils/SubstringMatcher.h"
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  inline unsigned char lower( unsigned char ch_r )
+  { return( ch_r >= 'A' && ch_r <= 'Z' ? ch_r + ( 'a' - 'A' ) : ch_r ); }
+
+  inline bool lessChar( const std::pair<unsigned char,unsigned> & lhs, unsigned char rhs )
+  { return lhs.first < rhs; }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+SubstringMatcher::SubstringMatcher( const std::vector<std::string> & patterns_r )
+: _nodes( 1 )
+, _patterns( patterns_r.size() )
+{
+  // the trie
+  for ( unsigned idx = 0; idx < patterns_r.size(); ++idx )
+  {
+    unsigned node = 0;
+    for ( unsigned char ch : patterns_r[idx] )
+    {
+      ch = lower( ch );
+      unsigned next = child( node, ch );
+      if ( ! next )
+      {
+	next = _nodes.size();
+	_nodes.push_back( Node() );	// invalidates references into _nodes
+	auto & edges( _nodes[node].next );
+	edges.insert( std::lower_bound( edges.begin(), edges.end(), ch, lessChar ), std::make_pair( ch, next ) );
+      }
+      node = next;
+    }
+    _nodes[node].outputs.push_back( idx );
+  }
+
+  // fail links, breadth first so a nodes fail node is complete before the node
+  std::deque<unsigned> todo;
+  for ( const auto & edge : _nodes[0].next )
+    todo.push_back( edge.second );	// depth 1 nodes fail to the root
+  while ( ! todo.empty() )
+  {
+    unsigned node = todo.front();
+    todo.pop_front();
+    for ( const auto & edge : _nodes[node].next )
+    {
+      unsigned fail = _nodes[node].fail;
+      while ( fail && ! child( fail, edge.first ) )
+	fail = _nodes[fail].fail;
+      _nodes[edge.second].fail = child( fail, edge.first );
+      todo.push_back( edge.second );
+    }
+    // the roots outputs (empty patterns) are not inherited, they match any text
+    unsigned fail = _nodes[node].fail;
+    if ( fail )
+      _nodes[node].outputs.insert( _nodes[node].outputs.end(), _nodes[fail].outputs.begin(), _nodes[fail].outputs.end() );
+  }
+}
+
+unsigned SubstringMatcher::child( unsigned node_r, unsigned char ch_r ) const
+{
+  const auto & edges( _nodes[node_r].next );
+  auto it = std::lower_bound( edges.begin(), edges.end(), ch_r, lessChar );
+  return( it != edges.end() && it->first == ch_r ? it->second : 0 );
+}
+
+unsigned SubstringMatcher::step( unsigned node_r, unsigned char ch_r ) const
+{
+  while ( true )
+  {
+    unsigned next = child( node_r, ch_r );
+    if ( next || ! node_r )
+      return next;
+    node_r = _nodes[node_r].fail;
+  }
+}
+
+void SubstringMatcher::find( boost::string_ref text_r, std::vector<unsigned> & result_r ) const
+{
+  size_t begin = result_r.size();
+  const std::vector<unsigned> & empty( _nodes[0].outputs );
+  result_r.insert( result_r.end(), empty.begin(), empty.end() );
+
+  unsigned node = 0;
+  for ( unsigned char ch : text_r )
+  {
+    node = step( node, lower( ch ) );
+    if ( node )
+      result_r.insert( result_r.end(), _nodes[node].outputs.begin(), _nodes[node].outputs.end() );
+  }
+
+  std::sort( result_r.begin() + begin, result_r.end() );
+  result_r.erase( std::unique( result_r.begin() + begin, result_r.end() ), result_r.end() );
+}
+
+bool SubstringMatcher::matches( boost::string_ref text_r ) const
+{
+  if ( ! _nodes[0].outputs.empty() )
+    return true;
+
+  unsigned node = 0;
+  for ( unsigned char ch : text_r )
+  {
+    node = step( node, lower( ch ) );
+    if ( node && ! _nodes[node].outputs.empty() )
+      return true;
+  }
+  return false;
+}
@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#ifndef ZYPPER_UTILS_SUBSTRINGMATCHER_H_
+#define ZYPPER_UTILS_SUBSTRINGMATCHER_H_
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include <boost/utility/string_ref.hpp>
+
+///////////////////////////////////////////////////////////////////
+/// \class SubstringMatcher
+/// \brief Find which of many patterns are contained in a text, in a single pass.
+///
+/// An Aho-Corasick automaton built from the patterns. Matching a text
+/// costs one pass over its bytes, no matter how many patterns there are,
+/// where a \ref zypp::StrMatcher per pattern would need one pass each.
+///
+/// Matching is case insensitive for ASCII letters (like \c strcasestr,
+/// which libsolv uses for \ref zypp::Match::SUBSTRING | \ref zypp::Match::NOCASE).
+/// An empty pattern is contained in every text.
+///
+/// \code
+///   SubstringMatcher matcher( { "CVE-2015", "bnc" } );
+///   std::vector<unsigned> found;
+///   matcher.find( "cve-2015-1234", found );	// found: { 0 }
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class SubstringMatcher
+{
+public:
+  /** Ctor: match \a patterns_r. Matches are reported by their index in \a patterns_r. */
+  SubstringMatcher( const std::vector<std::string> & patterns_r );
+
+  /** Number of patterns. */
+  unsigned size() const
+  { return _patterns; }
+
+  /** Append the indexes of all patterns contained in \a text_r to \a result_r.
+   * The appended indexes are sorted and unique.
+   */
+  void find( boost::string_ref text_r, std::vector<unsigned> & result_r ) const;
+
+  /** Whether any pattern is contained in \a text_r. */
+  bool matches( boost::string_ref text_r ) const;
+
+private:
+  struct Node
+  {
+    Node() : fail( 0 ) {}
+    std::vector<std::pair<unsigned char,unsigned>> next;	///< sorted by char
+    unsigned fail;			///< longest proper suffix which is a node too
+    std::vector<unsigned> outputs;	///< patterns ending here, including those of the fail chain
+  };
+
+  unsigned child( unsigned node_r, unsigned char ch_r ) const;
+  unsigned step( unsigned node_r, unsigned char ch_r ) const;
+
+private:
+  std::vector<Node> _nodes;	///< the root is node 0
+  unsigned _patterns;
+};
+
+#endif // ZYPPER_UTILS_SUBSTRINGMATCHER_H_
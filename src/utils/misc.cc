@@ -540,6 +540,27 @@ DownloadMode get_download_option(Zypper & zypper, bool quiet)
   return mode;
 }
 
+unsigned get_parallel_option(Zypper & zypper)
+{
+  unsigned ret = zypper.config().parallelDownloads;
+
+  parsed_opts::const_iterator it = zypper.cOpts().find("parallel");
+  if (it != zypper.cOpts().end())
+  {
+    ret = str::strtonum<unsigned>(it->second.back());
+    if (!ret)
+    {
+      zypper.out().error(str::form(_("Invalid value '%s' of the %s option."), it->second.back().c_str(), "--parallel"));
+      zypper.out().info(_("Expecting a number greater than zero."));
+      zypper.setExitCode(ZYPPER_EXIT_ERR_INVALID_ARGS);
+      ZYPP_THROW( ExitRequestException("Invalid --parallel value") );
+    }
+  }
+
+  MIL << "Parallel download jobs: " << ret << endl;
+  return ret;
+}
+
 // ----------------------------------------------------------------------------
 
 bool packagekit_running()
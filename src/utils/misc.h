@@ -127,6 +127,12 @@ std::string asXML(const zypp::Pattern & p, bool is_installed);
  */
 zypp::DownloadMode get_download_option(Zypper & zypper, bool quiet = false);
 
+/**
+ * Return the number of download jobs to run in parallel. The value is taken
+ * from the commands --parallel option, or from zypper.conf(main.parallelDownloads).
+ */
+unsigned get_parallel_option(Zypper & zypper);
+
 /** Check whether packagekit is running using a DBus call */
 bool packagekit_running();
 
@@ -7,10 +7,57 @@
 
 #include <cstring>
 #include <boost/utility/string_ref.hpp>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "utils/text.h"
 
 using namespace std;
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Length of the leading run of printable ASCII chars [0x20,0x7e] in \a text_r.
+   * Each of them occupies exactly one column.
+   */
+  inline size_t printableAsciiPrefix( const char * text_r, size_t size_r )
+  {
+    size_t pos = 0;
+#if defined(__SSE2__)
+    // Adding 0x60 maps [0x20,0x7e] to [-128,-34] (as signed char),
+    // everything else to [-33,127]. So one compare per 16 chars.
+    const __m128i bias( _mm_set1_epi8( 0x60 ) );
+    const __m128i limit( _mm_set1_epi8( -33 ) );
+    for ( ; pos + 16 <= size_r; pos += 16 )
+    {
+      __m128i chunk( _mm_loadu_si128( reinterpret_cast<const __m128i *>( text_r + pos ) ) );
+      int mask = _mm_movemask_epi8( _mm_cmplt_epi8( _mm_add_epi8( chunk, bias ), limit ) );
+      if ( mask != 0xffff )
+	return pos + __builtin_ctz( ~mask );
+    }
+#endif
+    for ( ; pos < size_r; ++pos )
+    {
+      unsigned char ch = text_r[pos];
+      if ( ch < 0x20 || ch > 0x7e )
+	break;
+    }
+    return pos;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+size_t mbs_width( boost::string_ref text_r )
+{
+  size_t ret = printableAsciiPrefix( text_r.data(), text_r.size() );
+  if ( ret < text_r.size() )
+  {
+    for( mbs::MbsIterator it( text_r.substr( ret ) ); ! it.atEnd(); ++it )
+      ret += it.columns();
+  }
+  return ret;
+}
+
 std::string mbs_substr_by_width( boost::string_ref text_r, std::string::size_type colpos_r, std::string::size_type collen_r )
 {
   std::string ret;
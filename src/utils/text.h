@@ -592,14 +592,11 @@ inline void mbs_write_wrapped( std::ostream & out, boost::string_ref text_r, siz
   mww.addString( text_r );
 }
 
-/** Returns the column width of a multi-byte character string \a text_r */
-inline size_t mbs_width( boost::string_ref text_r )
-{
-  size_t ret = 0;
-  for( mbs::MbsIterator it( text_r ); ! it.atEnd(); ++it )
-    ret += it.columns();
-  return ret;
-}
+/** Returns the column width of a multi-byte character string \a text_r
+ * \note A leading run of printable ASCII chars is counted without
+ * decoding it; the rest is handled by \ref mbs::MbsIterator.
+ */
+size_t mbs_width( boost::string_ref text_r );
 
 /**
  * Returns a substring of a multi-byte character string \a text_r starting
@@ -0,0 +1,234 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+#include <fstream>
+
+#include <zypp/sat/LookupAttr.h>
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "FullTextIndex.h"
+#include "search.h"
+
+using namespace std;
+using namespace zypp;
+
+static TestSetup test( Arch_x86_64 );
+
+namespace
+{
+  Pathname solvCachePath()
+  { return RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath; }
+
+  Repository loadUpdates()
+  {
+    Repository repo( test.satpool().reposFind( "updates" ) );
+    if ( ! repo )
+    {
+      test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_updates", "updates" );
+      repo = test.satpool().reposFind( "updates" );
+    }
+    return repo;
+  }
+
+  /** The solvables found by iterating the query with text attributes in-process. */
+  vector<sat::Solvable> expected( PoolQuery query_r, const vector<string> & texts_r )
+  {
+    for ( const string & text : texts_r )
+    {
+      query_r.addAttribute( sat::SolvAttr::summary, text );
+      query_r.addAttribute( sat::SolvAttr::description, text );
+    }
+    vector<sat::Solvable> ret;
+    for_( it, query_r.begin(), query_r.end() )
+      ret.push_back( *it );
+    return ret;
+  }
+
+  /** The solvables found by iterating the query with full path file list dependencies in-process. */
+  vector<sat::Solvable> expectedFiles( PoolQuery query_r, const vector<string> & files_r )
+  {
+    query_r.setFilesMatchFullPath( true );
+    for ( const string & file : files_r )
+      query_r.addDependency( sat::SolvAttr::filelist, file );
+    vector<sat::Solvable> ret;
+    for_( it, query_r.begin(), query_r.end() )
+      ret.push_back( *it );
+    return ret;
+  }
+
+  PoolQuery nameQuery( const string & name_r )
+  {
+    PoolQuery query;
+    query.addDependency( sat::SolvAttr::name, name_r );
+    return query;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(fulltext_index_build)
+{
+  Repository repo( loadUpdates() );
+  Pathname cacheDir( solvCachePath() / "updates" );
+
+  filesystem::unlink( cacheDir / FullTextIndex::fileName( FullTextIndex::TEXTS ) );
+  BOOST_CHECK( ! FullTextIndex( repo, cacheDir ).isValid() );
+  BOOST_REQUIRE( FullTextIndex::build( repo, cacheDir ) );
+
+  FullTextIndex index( repo, cacheDir );
+  BOOST_REQUIRE( index.isValid() );
+
+  BOOST_CHECK( FullTextIndex::isIndexable( "foo" ) );
+  BOOST_CHECK( ! FullTextIndex::isIndexable( "fo" ) );
+  BOOST_CHECK( ! FullTextIndex::isIndexable( "玄米茶" ) );
+
+  // candidates are a superset of the matches
+  vector<sat::Solvable> candidates;
+  index.candidates( "SeCuRiTy", candidates );
+  vector<sat::Solvable> matches( expected( PoolQuery(), { "security" } ) );
+  BOOST_CHECK( ! matches.empty() );
+  BOOST_CHECK( includes( candidates.begin(), candidates.end(), matches.begin(), matches.end(),
+			 []( sat::Solvable lhs, sat::Solvable rhs ) { return lhs.id() < rhs.id(); } ) );
+
+  candidates.clear();
+  index.candidates( "no such text in any description", candidates );
+  BOOST_CHECK( candidates.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(fulltext_index_outdated)
+{
+  Repository repo( loadUpdates() );
+  Pathname cacheDir( solvCachePath() / "updates" );
+  BOOST_REQUIRE( FullTextIndex::build( repo, cacheDir ) );
+
+  string cookie;
+  {
+    ifstream in( ( cacheDir / "cookie" ).c_str() );
+    getline( in, cookie, '\0' );
+  }
+  ofstream( ( cacheDir / "cookie" ).c_str() ) << "changed" << cookie;
+  BOOST_CHECK( ! FullTextIndex( repo, cacheDir ).isValid() );
+
+  ofstream( ( cacheDir / "cookie" ).c_str() ) << cookie;
+  BOOST_CHECK( FullTextIndex( repo, cacheDir ).isValid() );
+}
+
+BOOST_AUTO_TEST_CASE(text_query)
+{
+  Repository repo( loadUpdates() );
+  BOOST_REQUIRE( FullTextIndex::build( repo, solvCachePath() / "updates" ) );
+
+  // substring, case insensitive and sensitive
+  for ( const vector<string> & texts : vector<vector<string>>{ { "security" }, { "Security" }, { "kde", "gnome" } } )
+  {
+    PoolQuery query( nameQuery( texts.front() ) );
+    BOOST_CHECK( textQuery( query, texts, {}, {}, solvCachePath() ) == expected( query, texts ) );
+    query.setCaseSensitive();
+    BOOST_CHECK( textQuery( query, texts, {}, {}, solvCachePath() ) == expected( query, texts ) );
+  }
+
+  // words
+  PoolQuery query( nameQuery( "fix" ) );
+  query.setMatchWord();
+  BOOST_CHECK( textQuery( query, { "fix" }, {}, {}, solvCachePath() ) == expected( query, { "fix" } ) );
+
+  // by kind
+  query = nameQuery( "update" );
+  query.addKind( ResKind::patch );
+  BOOST_CHECK( textQuery( query, { "update" }, {}, {}, solvCachePath() ) == expected( query, { "update" } ) );
+
+  // not indexable
+  query = nameQuery( "x" );
+  BOOST_CHECK( textQuery( query, { "x" }, {}, {}, solvCachePath() ) == expected( query, { "x" } ) );
+}
+
+BOOST_AUTO_TEST_CASE(file_query)
+{
+  Repository repo( loadUpdates() );
+  BOOST_REQUIRE( FullTextIndex::build( repo, solvCachePath() / "updates", FullTextIndex::FILES ) );
+  BOOST_REQUIRE( FullTextIndex( repo, solvCachePath() / "updates", FullTextIndex::FILES ).isValid() );
+
+  // some path in the file lists
+  string path;
+  for_( it, repo.solvablesBegin(), repo.solvablesEnd() )
+  {
+    sat::LookupAttr files( sat::SolvAttr::filelist, *it );
+    if ( files.begin() != files.end() )
+    {
+      path = files.begin().asString();
+      break;
+    }
+  }
+  BOOST_REQUIRE( ! path.empty() );
+
+  // file lists only (like 'search -f')
+  for ( const vector<string> & files : vector<vector<string>>{ { "bin/" }, { "/USR/" }, { path } } )
+  {
+    PoolQuery query;
+    BOOST_CHECK( textQuery( query, {}, files, {}, solvCachePath(), false ) == expectedFiles( query, files ) );
+    query.setCaseSensitive();
+    BOOST_CHECK( textQuery( query, {}, files, {}, solvCachePath(), false ) == expectedFiles( query, files ) );
+  }
+  BOOST_CHECK( ! expectedFiles( PoolQuery(), { path } ).empty() );
+
+  // exact path along with provides (like 'what-provides /path')
+  PoolQuery query;
+  query.setMatchExact();
+  query.addDependency( sat::SolvAttr::provides, path );
+  BOOST_CHECK( textQuery( query, {}, { path }, {}, solvCachePath() ) == expectedFiles( query, { path } ) );
+
+  // not indexable
+  query = PoolQuery();
+  BOOST_CHECK( textQuery( query, {}, { "/x" }, {}, solvCachePath(), false ) == expectedFiles( query, { "/x" } ) );
+}
+
+BOOST_AUTO_TEST_CASE(file_query_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  Repository repo( loadUpdates() );
+  BOOST_REQUIRE( FullTextIndex::build( repo, solvCachePath() / "updates", FullTextIndex::FILES ) );
+
+  vector<sat::Solvable> plain;
+  {
+    Timer timer( "PoolQuery filelist" );
+    for ( unsigned i = 0; i < 20; ++i )
+      plain = expectedFiles( PoolQuery(), { "/usr/bin/" } );
+  }
+  vector<sat::Solvable> indexed;
+  {
+    Timer timer( "FullTextIndex filelist" );
+    for ( unsigned i = 0; i < 20; ++i )
+      indexed = textQuery( PoolQuery(), {}, { "/usr/bin/" }, {}, solvCachePath(), false );
+  }
+  BOOST_CHECK( indexed == plain );
+}
+
+BOOST_AUTO_TEST_CASE(text_query_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  Repository repo( loadUpdates() );
+  BOOST_REQUIRE( FullTextIndex::build( repo, solvCachePath() / "updates" ) );
+  PoolQuery query( nameQuery( "library" ) );
+
+  vector<sat::Solvable> plain;
+  {
+    Timer timer( "PoolQuery" );
+    for ( unsigned i = 0; i < 20; ++i )
+      plain = expected( query, { "library" } );
+  }
+  vector<sat::Solvable> indexed;
+  {
+    Timer timer( "FullTextIndex" );
+    for ( unsigned i = 0; i < 20; ++i )
+      indexed = textQuery( query, { "library" }, {}, {}, solvCachePath() );
+  }
+  BOOST_CHECK( indexed == plain );
+}
@@ -0,0 +1,180 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <fstream>
+
+#include <zypp/PoolQuery.h>
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "IssueIndex.h"
+
+using namespace std;
+using namespace zypp;
+
+static TestSetup test( Arch_x86_64 );
+
+namespace
+{
+  const unsigned refsPerPatch = 10;
+
+  /** A synthetic updateinfo.xml. Fewer distinct IDs than references, so
+   * some IDs are shared (multiples of 3, so shared IDs have the same type). */
+  struct Fixture
+  {
+    const char * alias;
+    unsigned patches;
+    unsigned distinctIds;
+  };
+  const Fixture small { "issues", 200, 1500 };
+  const Fixture bench { "issues-bench", 20000, 150000 };
+
+  /** Reference \a ref_r: every third one a CVE, the others bugzilla. */
+  string refType( unsigned ref_r )
+  { return( ref_r % 3 ? "bugzilla" : "cve" ); }
+
+  string refId( unsigned ref_r, const Fixture & fixture_r = small )
+  {
+    unsigned num = ref_r % fixture_r.distinctIds;
+    return( ref_r % 3 ? str::numstring( 800000 + num ) : "CVE-2015-" + str::numstring( 10000 + num ) );
+  }
+
+  /** Write and load an rpm-md repo containing the \a fixture_r updateinfo.xml only. */
+  void loadRepo( const Fixture & fixture_r )
+  {
+    if ( test.satpool().reposFind( fixture_r.alias ) )
+      return;
+
+    Pathname dir( test.root() / fixture_r.alias );
+    filesystem::assert_dir( dir / "repodata" );
+    ofstream( ( dir / "repodata/repomd.xml" ).c_str() )
+      << "<?xml version=\"1.0\" ?>\n"
+      << "<repomd xmlns=\"http://linux.duke.edu/metadata/repo\">\n"
+      << "  <data type=\"primary\"><location href=\"repodata/primary.xml\"/></data>\n"
+      << "  <data type=\"updateinfo\"><location href=\"repodata/updateinfo.xml\"/></data>\n"
+      << "</repomd>\n";
+    ofstream( ( dir / "repodata/primary.xml" ).c_str() )
+      << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<metadata xmlns=\"http://linux.duke.edu/metadata/common\" xmlns:rpm=\"http://linux.duke.edu/metadata/rpm\" packages=\"0\">\n"
+      << "</metadata>\n";
+
+    ofstream updateinfo( ( dir / "repodata/updateinfo.xml" ).c_str() );
+    updateinfo << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<updates>\n";
+    for ( unsigned patch = 0; patch < fixture_r.patches; ++patch )
+    {
+      updateinfo
+	<< "<update from=\"maint\" status=\"stable\" type=\"security\" version=\"1\">\n"
+	<< "  <id>" << fixture_r.alias << "-" << patch << "</id>\n"
+	<< "  <title>patch " << patch << "</title>\n"
+	<< "  <issued date=\"1230000000\"/>\n"
+	<< "  <references>\n";
+      for ( unsigned ref = patch * refsPerPatch; ref < ( patch + 1 ) * refsPerPatch; ++ref )
+      {
+	updateinfo << "    <reference href=\"http://example.com/" << ref << "\" id=\"" << refId( ref, fixture_r )
+		   << "\" title=\"issue " << ref << "\" type=\"" << refType( ref ) << "\"/>\n";
+      }
+      updateinfo
+	<< "  </references>\n"
+	<< "  <description>synthetic patch</description>\n"
+	<< "</update>\n";
+    }
+    updateinfo << "</updates>\n";
+    updateinfo.close();
+
+    test.loadRepo( dir, fixture_r.alias );
+  }
+
+  /** The patches found by a PoolQuery per issue (like mark_updates_by_issue used to). */
+  vector<sat::Solvable> queried( const string & type_r, const string & id_r )
+  {
+    PoolQuery q;
+    q.setMatchExact();
+    q.setCaseSensitive( false );
+    q.addKind( ResKind::patch );
+    if ( id_r.empty() )
+      q.addAttribute( sat::SolvAttr::updateReferenceType, type_r );
+    else
+      q.addAttribute( sat::SolvAttr::updateReferenceId, id_r );
+
+    vector<sat::Solvable> ret;
+    for_( it, q.begin(), q.end() )
+    {
+      for_( d, it.matchesBegin(), it.matchesEnd() )
+      {
+	if ( type_r.empty() || d->subFind( sat::SolvAttr::updateReferenceType ).asString() == type_r )
+	{
+	  ret.push_back( *it );
+	  break;
+	}
+      }
+    }
+    return ret;
+  }
+
+  vector<sat::Solvable> found( const IssueIndex & index_r, const string & type_r, const string & id_r )
+  {
+    vector<sat::Solvable> ret;
+    index_r.find( type_r, id_r, ret );
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(issue_index)
+{
+  loadRepo( small );
+  IssueIndex index;
+  BOOST_CHECK_EQUAL( index.size(), small.patches * refsPerPatch );
+
+  // IDs shared by two patches, case insensitive
+  BOOST_CHECK_EQUAL( found( index, "cve", refId( 3 ) ).size(), 2 );
+  BOOST_CHECK( found( index, "cve", str::toLower( refId( 3 ) ) ) == queried( "cve", refId( 3 ) ) );
+  BOOST_CHECK( found( index, "", refId( 4 ) ) == queried( "", refId( 4 ) ) );
+  BOOST_CHECK_EQUAL( found( index, "bugzilla", refId( 4 ) ).size(), 2 );
+
+  // type must match
+  BOOST_CHECK( found( index, "cve", refId( 4 ) ).empty() );
+  BOOST_CHECK( found( index, "bugzilla", "no-such-id" ).empty() );
+
+  // any ID of a type
+  BOOST_CHECK_EQUAL( found( index, "cve", "" ).size(), small.patches );
+  BOOST_CHECK( found( index, "cve", "" ) == queried( "cve", "" ) );
+  BOOST_CHECK( found( index, "fate", "" ).empty() );
+
+  // appends
+  vector<sat::Solvable> patches;
+  index.find( "cve", refId( 3 ), patches );
+  index.find( "bugzilla", refId( 4 ), patches );
+  BOOST_CHECK_EQUAL( patches.size(), 4 );
+}
+
+BOOST_AUTO_TEST_CASE(issue_index_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  loadRepo( bench );
+
+  // 500 issues, like 'zypper patch --cve=<list of 500>'
+  vector<pair<string,string>> issues;
+  for ( unsigned ref = 0; issues.size() < 500; ref += 397 )
+    issues.push_back( make_pair( refType( ref ), refId( ref, bench ) ) );
+
+  vector<vector<sat::Solvable>> plain;
+  {
+    Timer timer( "PoolQuery per issue" );
+    for ( const auto & issue : issues )
+      plain.push_back( queried( issue.first, issue.second ) );
+  }
+  vector<vector<sat::Solvable>> indexed;
+  {
+    Timer timer( "IssueIndex" );
+    IssueIndex index;
+    for ( const auto & issue : issues )
+      indexed.push_back( found( index, issue.first, issue.second ) );
+  }
+  BOOST_CHECK( indexed == plain );
+}
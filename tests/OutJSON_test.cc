@@ -0,0 +1,67 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "output/OutJSON.h"
+#include "search.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(json_line)
+{
+  string buffer;
+  ostringstream str;
+  JsonLine( buffer, "test" )
+    .str( "text", "a \"quoted\" \\ line\n\twith \x01 control chars, Koľko" )
+    .num( "num", -1 )
+    .flag( "flag", true )
+    .beginArray( "list" ).str( nullptr, "a" ).num( nullptr, 2 ).beginObject().endObject().endArray()
+    .beginObject( "obj" ).str( "k", "v" ).endObject()
+    .write( str );
+  BOOST_CHECK_EQUAL( str.str(),
+		     "{\"event\":\"test\""
+		     ",\"text\":\"a \\\"quoted\\\" \\\\ line\\n\\twith \\u0001 control chars, Koľko\""
+		     ",\"num\":-1,\"flag\":true"
+		     ",\"list\":[\"a\",2,{}]"
+		     ",\"obj\":{\"k\":\"v\"}}\n" );
+
+  // the buffer is reused
+  str.str( "" );
+  JsonLine( buffer, "empty" ).write( str );
+  BOOST_CHECK_EQUAL( str.str(), "{\"event\":\"empty\"}\n" );
+}
+
+BOOST_AUTO_TEST_CASE(json_table)
+{
+  CaptureCout capture;
+  {
+    OutJSON out;
+    Table t;
+    t << ( TableHeader() << "S" << "Name" );
+    t << ( TableRow() << "i" << "zypper" );
+    t << ( TableRow() << "" << "libzypp" );
+    out.table( t );
+  }
+  BOOST_CHECK_EQUAL( capture.str(),
+		     "{\"event\":\"table\",\"header\":[\"S\",\"Name\"]}\n"
+		     "{\"event\":\"row\",\"columns\":[\"i\",\"zypper\"]}\n"
+		     "{\"event\":\"row\",\"columns\":[\"\",\"libzypp\"]}\n" );
+}
+
+BOOST_AUTO_TEST_CASE(json_search_sink)
+{
+  ostringstream str;
+  JsonSearchSink json( str );
+  json.add( "vL", { { "name", "zypper" }, { "kind", "package" } } );
+  json.add( "", { { "name", "libzypp" } } );
+  json.finish();
+  BOOST_CHECK_EQUAL( json.size(), 2 );
+  BOOST_CHECK_EQUAL( str.str(),
+		     "{\"event\":\"solvable\",\"status\":\"other-version\",\"name\":\"zypper\",\"kind\":\"package\"}\n"
+		     "{\"event\":\"solvable\",\"status\":\"not-installed\",\"name\":\"libzypp\"}\n" );
+}
@@ -0,0 +1,114 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <sstream>
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "PackageArgs.h"
+
+using namespace std;
+using namespace zypp;
+
+static TestSetup test(Arch_x86_64);
+
+namespace
+{
+  bool hasSpec( const PackageArgs::PackageSpecSet & specs_r, const Capability & cap_r )
+  {
+    PackageSpec spec;
+    spec.parsed_cap = cap_r;
+    return specs_r.find( spec ) != specs_r.end();
+  }
+
+  string manifest( unsigned count_r )
+  {
+    ostringstream str;
+    str << "# generated" << endl;
+    for ( unsigned i = 0; i < count_r; ++i )
+      str << "package" << i << ( i % 3 ? "" : " >= 1.0" ) << endl;
+    return str.str();
+  }
+} // namespace
+
+BOOST_AUTO_TEST_CASE(manifest_test)
+{
+  istringstream in(
+    "# comment\n"
+    "\n"
+    "zypper >= 1.4.0\n"
+    "  perl(Math::BigInt)\r\n"
+    "pattern:laptop\n"
+    "vim emacs\n"
+    "zypper>=1.4.0\n"
+    "-irda\n" );
+
+  PackageArgs args( in );
+  // nothing on the command line
+  BOOST_CHECK( args.asStringSet().empty() );
+
+  const PackageArgs::PackageSpecSet & specs( args.dos() );
+  BOOST_CHECK( hasSpec( specs, Capability( "", "zypper", ">=", "1.4.0" ) ) );
+  BOOST_CHECK( hasSpec( specs, Capability( "perl(Math::BigInt)" ) ) );
+  BOOST_CHECK( hasSpec( specs, Capability( "laptop", ResKind::pattern ) ) );
+  BOOST_CHECK( hasSpec( specs, Capability( "vim" ) ) );
+  BOOST_CHECK( hasSpec( specs, Capability( "emacs" ) ) );
+  BOOST_CHECK_EQUAL( specs.size(), 5 );
+
+  BOOST_CHECK( hasSpec( args.donts(), Capability( "irda" ) ) );
+  BOOST_CHECK_EQUAL( args.donts().size(), 1 );
+}
+
+BOOST_AUTO_TEST_CASE(manifest_dupes_test)
+{
+  istringstream in(
+    "zypper>=1.4.0\n"
+    "zypper >= 1.4.0\n"
+    "-zypper>=1.4.0\n" );
+
+  PackageArgs args( in );
+  BOOST_CHECK( args.empty() );
+}
+
+BOOST_AUTO_TEST_CASE(manifest_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  // the manifest must scale linearly, compare 10k and 100k entries
+  for ( unsigned count : { 10000U, 100000U } )
+  {
+    string text( manifest( count ) + manifest( count ) );	// each spec twice
+    vector<string> argv;
+    {
+      istringstream in( text );
+      string word;
+      while ( in >> word )
+	if ( word[0] != '#' )
+	  argv.push_back( word );
+    }
+
+    cerr << count << " specs" << endl;
+    unsigned plain = 0;
+    {
+      Timer timer( "  arguments" );
+      PackageArgs args( argv );
+      plain = args.dos().size();
+    }
+    unsigned read = 0;
+    {
+      Timer timer( "  manifest" );
+      istringstream in( text );
+      PackageArgs args( in );
+      read = args.dos().size();
+    }
+    BOOST_CHECK_EQUAL( plain, count );
+    BOOST_CHECK_EQUAL( read, count );
+  }
+}
+
+// vim: set ts=2 sts=8 sw=2 ai et:
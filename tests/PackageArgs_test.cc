@@ -6,6 +6,7 @@
 \*---------------------------------------------------------------------------*/
 
 #include "TestSetup.h"
+#include "TestHelpers.h"
 #include "PackageArgs.h"
 
 using namespace std;
@@ -217,4 +218,103 @@ BOOST_AUTO_TEST_CASE(argToCaps_with_patch_test)
   }
 }
 
+BOOST_AUTO_TEST_CASE(spec_set_test)
+{
+  PackageSpecSet specs;
+  for (unsigned i = 0; i < 1000; ++i)
+  {
+    PackageSpec spec;
+    spec.orig_str = str::numstring(i);
+    spec.parsed_cap = Capability("package" + str::numstring(i));
+    BOOST_CHECK(specs.insert(spec).second);
+  }
+  BOOST_CHECK_EQUAL(specs.size(), 1000);
+
+  // same capability, different repo: not inserted
+  PackageSpec dupe;
+  dupe.parsed_cap = Capability("package7");
+  dupe.repo_alias = "other";
+  BOOST_CHECK(!specs.insert(dupe).second);
+  BOOST_CHECK_EQUAL(specs.find(dupe)->orig_str, "7");
+
+  // erase every other spec, the rest must still be found
+  for (unsigned i = 0; i < 1000; i += 2)
+  {
+    PackageSpec spec;
+    spec.parsed_cap = Capability("package" + str::numstring(i));
+    PackageSpecSet::const_iterator it = specs.find(spec);
+    BOOST_REQUIRE(it != specs.end());
+    specs.erase(it);
+  }
+  BOOST_CHECK_EQUAL(specs.size(), 500);
+  for (unsigned i = 0; i < 1000; ++i)
+  {
+    PackageSpec spec;
+    spec.parsed_cap = Capability("package" + str::numstring(i));
+    PackageSpecSet::const_iterator it = specs.find(spec);
+    BOOST_CHECK_EQUAL(it != specs.end(), i % 2 == 1);
+    if (it != specs.end())
+      BOOST_CHECK_EQUAL(it->orig_str, str::numstring(i));
+  }
+}
+
+namespace
+{
+  // what PackageSpecSet used to be
+  struct PackageSpecCompare
+  {
+    bool operator()(const PackageSpec & lhs, const PackageSpec & rhs) const
+    { return lhs.parsed_cap < rhs.parsed_cap; }
+  };
+} // namespace
+
+BOOST_AUTO_TEST_CASE(spec_set_benchmark)
+{
+  if (!runBenchmarks())
+    return;
+
+  vector<string> rawargs;
+  for (unsigned i = 0; i < 50000; ++i)
+  {
+    rawargs.push_back("package" + str::numstring(i));
+    if (i % 3 == 0)
+    {
+      rawargs.push_back(">=");
+      rawargs.push_back("1." + str::numstring(i % 10));
+    }
+  }
+  {
+    Timer timer("PackageArgs 50k");
+    PackageArgs args(rawargs);
+    BOOST_CHECK_EQUAL(args.dos().size(), 50000);
+  }
+
+  vector<PackageSpec> input;
+  for (unsigned i = 0; i < 50000; ++i)
+  {
+    PackageSpec spec;
+    spec.orig_str = "package" + str::numstring(i);
+    spec.parsed_cap = Capability(spec.orig_str);
+    input.push_back(spec);
+  }
+  unsigned found = 0;
+  {
+    Timer timer("std::set 50k");
+    set<PackageSpec, PackageSpecCompare> specs;
+    for (const PackageSpec & spec : input)
+      specs.insert(spec);
+    for (const PackageSpec & spec : input)
+      found += specs.count(spec);
+  }
+  {
+    Timer timer("PackageSpecSet 50k");
+    PackageSpecSet specs;
+    for (const PackageSpec & spec : input)
+      specs.insert(spec);
+    for (const PackageSpec & spec : input)
+      found += specs.find(spec) != specs.end();
+  }
+  BOOST_CHECK_EQUAL(found, 100000);
+}
+
 // vim: set ts=2 sts=8 sw=2 ai et:
@@ -0,0 +1,94 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "search.h"
+
+using namespace std;
+using namespace zypp;
+
+static TestSetup test( Arch_x86_64 );
+
+namespace
+{
+  const unsigned testSolvables = 40000;	// enough for two jobs
+  const unsigned benchSolvables = 150000;
+
+  /** Load copies of the openSUSE-11.1_updates repo until the pool has \a solvables_r. */
+  void loadPool( unsigned solvables_r )
+  {
+    if ( test.satpool().reposEmpty() )
+      test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_updates", "updates-0" );
+    Pathname solv( RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath / "updates-0" / "solv" );
+    for ( unsigned i = test.satpool().reposSize(); test.satpool().solvablesSize() < solvables_r; ++i )
+      test.loadRepo( solv, "updates-" + str::numstring( i ) );
+  }
+
+  /** Regex search in summaries and descriptions (like 'search -d /.../'). */
+  PoolQuery descriptionQuery()
+  {
+    PoolQuery query;
+    query.setMatchRegex();
+    query.addAttribute( sat::SolvAttr::summary, "secur.*(fix|update)" );
+    query.addAttribute( sat::SolvAttr::description, "secur.*(fix|update)" );
+    return query;
+  }
+
+  /** The selectables found by iterating \a query_r in-process. */
+  vector<ui::Selectable::Ptr> serialSelectables( PoolQuery query_r, const set<string> & repos_r )
+  {
+    for ( const string & alias : repos_r )
+      query_r.addRepo( alias );
+    return vector<ui::Selectable::Ptr>( query_r.selectableBegin(), query_r.selectableEnd() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_query)
+{
+  loadPool( testSolvables );
+  PoolQuery query( descriptionQuery() );
+
+  vector<ui::Selectable::Ptr> expected( serialSelectables( query, {} ) );
+  BOOST_CHECK( ! expected.empty() );
+  BOOST_CHECK( selectablesOf( parallelQuery( query, {}, 1 ) ) == expected );
+  BOOST_CHECK( selectablesOf( parallelQuery( query, {}, 4 ) ) == expected );
+
+  // results are in pool order
+  vector<sat::Solvable> solvables( parallelQuery( query, {}, 4 ) );
+  BOOST_CHECK( is_sorted( solvables.begin(), solvables.end(),
+			  []( const sat::Solvable & lhs, const sat::Solvable & rhs )
+			  { return lhs.id() < rhs.id(); } ) );
+
+  // restricted to some repos
+  set<string> repos { "updates-0", "updates-2" };
+  BOOST_CHECK( selectablesOf( parallelQuery( query, repos, 2 ) ) == serialSelectables( query, repos ) );
+}
+
+BOOST_AUTO_TEST_CASE(parallel_query_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  loadPool( benchSolvables );
+  cerr << "Pool: " << test.satpool().solvablesSize() << " solvables in " << test.satpool().reposSize() << " repos" << endl;
+  PoolQuery query( descriptionQuery() );
+
+  vector<ui::Selectable::Ptr> serial;
+  {
+    Timer timer( "PoolQuery" );
+    serial = serialSelectables( query, {} );
+  }
+  vector<ui::Selectable::Ptr> parallel;
+  {
+    Timer timer( "parallelQuery" );
+    parallel = selectablesOf( parallelQuery( query, {} ) );
+  }
+  BOOST_CHECK_EQUAL( parallel.size(), serial.size() );
+}
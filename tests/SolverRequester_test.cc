@@ -655,6 +655,51 @@ BOOST_AUTO_TEST_CASE(install403)
   BOOST_CHECK(hasPoolItem(sr.toInstall(), "popt", Edition("1.7-5.5"), Arch_x86_64));
   BOOST_CHECK(!sr.hasFeedback(SolverRequester::Feedback::NO_UPD_CANDIDATE));
 }
+
+///////////////////////////////////////////////////////////////////////////
+// Batch (many arguments, plain names resolved by name lookup)
+
+// request : install vim zypper nonsense
+// response: the same as installing each of them: vim and zypper-1.0.13-0.1.1
+//           set to install, nonsense not found by name nor cap
+BOOST_AUTO_TEST_CASE(install500)
+{
+  MIL << "<============install500===============>" << endl;
+
+  vector<string> rawargs;
+  rawargs.push_back("vim");
+  rawargs.push_back("zypper");
+  rawargs.push_back("nonsense");
+  SolverRequester sr;
+
+  sr.install(rawargs);
+
+  BOOST_CHECK(sr.hasFeedback(SolverRequester::Feedback::SET_TO_INSTALL));
+  BOOST_CHECK(sr.hasFeedback(SolverRequester::Feedback::NOT_FOUND_NAME_TRYING_CAPS));
+  BOOST_CHECK(sr.hasFeedback(SolverRequester::Feedback::NOT_FOUND_CAP));
+  BOOST_CHECK_EQUAL(sr.toInstall().size(), 2);
+  BOOST_CHECK(hasPoolItem(sr.toInstall(), "vim", Edition("7.2-7.4.1"), Arch_x86_64));
+  BOOST_CHECK(hasPoolItem(sr.toInstall(), "zypper", Edition("1.0.13-0.1.1"), Arch_x86_64));
+}
+
+// request : install --from main vim
+// response: plain name restricted to a repo, vim-7.2-1.3 from main set to install
+BOOST_AUTO_TEST_CASE(install501)
+{
+  MIL << "<============install501===============>" << endl;
+
+  vector<string> rawargs;
+  rawargs.push_back("vim");
+  SolverRequester::Options sropts;
+  sropts.from_repos.push_back("main");
+  SolverRequester sr(sropts);
+
+  sr.install(rawargs);
+
+  BOOST_CHECK_EQUAL(sr.toInstall().size(), 1);
+  BOOST_CHECK(hasPoolItem(sr.toInstall(), "vim", Edition("7.2-1.3"), Arch_x86_64));
+  BOOST_CHECK_EQUAL(sr.toInstall().begin()->repoInfo().alias(), "main");
+}
 ///////////////////////////////////////////////////////////////////////////
 
 
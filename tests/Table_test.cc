@@ -0,0 +1,145 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "Table.h"
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////
+// Count heap allocations done by the table code.
+namespace
+{
+  unsigned long allocations = 0;
+}
+
+void * operator new( std::size_t size_r )
+{
+  ++allocations;
+  if ( void * ret = std::malloc( size_r ? size_r : 1 ) )
+    return ret;
+  throw std::bad_alloc();
+}
+
+void operator delete( void * ptr_r ) noexcept
+{ std::free( ptr_r ); }
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Print the number of allocations done in scope to cerr. */
+  struct CountAllocations
+  {
+    CountAllocations( const char * name_r ) : _name( name_r ), _start( allocations ) {}
+    ~CountAllocations()
+    { cerr << _name << ":\t" << ( allocations - _start ) << " allocations" << endl; }
+    const char * _name;
+    unsigned long _start;
+  };
+
+  const unsigned benchRows = 200000;
+}
+
+BOOST_AUTO_TEST_CASE(table_sort)
+{
+  Table t;
+  t << ( TableHeader() << "S" << "Name" );
+  t << ( TableRow() << "i" << "zypper" );
+  t << ( TableRow() << "" << "libzypp" );
+  t << ( TableRow() << "v" << "augeas" );
+  t << ( TableRow() << "i" << "libzypp" );
+  t << ( TableRow() << "a" );	// rows missing the column go first
+
+  t.sort( 1 );
+  const Table::container & rows( t.rows() );
+  BOOST_REQUIRE_EQUAL( rows.size(), 5 );
+  BOOST_CHECK_EQUAL( rows[0].columns()[0], "a" );
+  BOOST_CHECK_EQUAL( rows[1].columns()[1], "augeas" );
+  // sort is stable
+  BOOST_CHECK_EQUAL( rows[2].columns()[0], "" );
+  BOOST_CHECK_EQUAL( rows[3].columns()[0], "i" );
+  BOOST_CHECK_EQUAL( rows[3].columns()[1], "libzypp" );
+  BOOST_CHECK_EQUAL( rows[4].columns()[1], "zypper" );
+}
+
+BOOST_AUTO_TEST_CASE(table_sort_typed)
+{
+  Table t;
+  t << ( TableHeader() << "#" << "Repo" << table::EditionStyleSetter( t, "Version" ) );
+  t.setNumericStyle( 0 );
+  t << ( TableRow() << "10" << "b" << "1.10-1" );
+  t << ( TableRow() << " 9" << "a" << "1.9-1" );
+  t << ( TableRow() << "n/a" << "b" << "1.9-2" );
+  t << ( TableRow() << "100" << "a" << "1.10-1" );
+
+  // numbers by value, non-numbers last
+  t.sort( 0 );
+  BOOST_CHECK_EQUAL( t.rows()[0].columns()[0], " 9" );
+  BOOST_CHECK_EQUAL( t.rows()[1].columns()[0], "10" );
+  BOOST_CHECK_EQUAL( t.rows()[2].columns()[0], "100" );
+  BOOST_CHECK_EQUAL( t.rows()[3].columns()[0], "n/a" );
+
+  // editions by version
+  t.sort( 2 );
+  BOOST_CHECK_EQUAL( t.rows()[0].columns()[2], "1.9-1" );
+  BOOST_CHECK_EQUAL( t.rows()[1].columns()[2], "1.9-2" );
+  BOOST_CHECK_EQUAL( t.rows()[2].columns()[2], "1.10-1" );
+  BOOST_CHECK_EQUAL( t.rows()[2].columns()[0], "10" );	// stable
+
+  // multiple columns
+  t.sort( { 1, 2 } );
+  BOOST_CHECK_EQUAL( t.rows()[0].columns()[0], " 9" );
+  BOOST_CHECK_EQUAL( t.rows()[1].columns()[0], "100" );
+  BOOST_CHECK_EQUAL( t.rows()[2].columns()[0], "n/a" );
+  BOOST_CHECK_EQUAL( t.rows()[3].columns()[0], "10" );
+}
+
+BOOST_AUTO_TEST_CASE(table_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  Table t;
+  {
+    CountAllocations count( "build" );
+    Timer timer( "build" );
+    t << ( TableHeader() << "S" << "Repository" << "Name" << "Version" << "Arch" );
+    for ( unsigned i = 0; i < benchRows; ++i )
+    {
+      // some pseudo random order
+      unsigned n = ( i * 7919U ) % benchRows;
+      t << ( TableRow( 5 )
+             << ( n % 3 ? "" : "i" )
+             << ( n % 2 ? "openSUSE-Tumbleweed-Oss" : "openSUSE-Tumbleweed-Update" )
+             << str::form( "package-%06u", n )
+             << str::form( "%u.%u.%u-%u.1", n % 7, n % 13, n % 31, n % 5 )
+             << ( n % 4 ? "x86_64" : "noarch" ) );
+    }
+  }
+  {
+    CountAllocations count( "sort" );
+    Timer timer( "sort" );
+    t.sort( 2 );
+  }
+  BOOST_REQUIRE_EQUAL( t.rows().size(), benchRows );
+  BOOST_CHECK_EQUAL( t.rows().front().columns()[2], "package-000000" );
+  BOOST_CHECK_EQUAL( t.rows().back().columns()[2], str::form( "package-%06u", benchRows-1 ) );
+
+  ostringstream out;
+  {
+    CountAllocations count( "render" );
+    Timer timer( "render" );
+    out << t;
+  }
+  const string & rendered( out.str() );
+  BOOST_CHECK_EQUAL( std::count( rendered.begin(), rendered.end(), '\n' ), benchRows + 2 );	// + header and rule
+}
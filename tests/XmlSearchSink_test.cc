@@ -0,0 +1,68 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "output/OutXML.h"
+#include "search.h"
+
+using namespace std;
+
+namespace
+{
+  const char * status( unsigned i_r )
+  { return i_r % 3 == 0 ? "i" : ( i_r % 3 == 1 ? "vL" : "" ); }
+
+  /** The search result via Table and OutXML::searchResult. */
+  string viaTable( unsigned rows_r )
+  {
+    CaptureCout capture;
+    OutXML out;
+    capture.clear();	// drop the stream header
+    {
+      Timer timer( "Table + OutXML" );
+      Table t;
+      t << ( TableHeader() << "S" << "Name" << "Summary" << "Type" );
+      for ( unsigned i = 0; i < rows_r; ++i )
+	t << ( TableRow() << status( i ) << str::form( "package-%u", i ) << "Summary with <&> \"quotes\"" << "package" );
+      out.searchResult( t );
+    }
+    string ret( capture.str() );
+    capture.clear();	// drop the stream footer
+    return ret;
+  }
+
+  /** The search result via XmlSearchSink. */
+  string viaSink( unsigned rows_r )
+  {
+    ostringstream str;
+    {
+      Timer timer( "XmlSearchSink" );
+      XmlSearchSink xml( str );
+      for ( unsigned i = 0; i < rows_r; ++i )
+	xml.add( status( i ), { { "name", str::form( "package-%u", i ) },
+				{ "summary", "Summary with <&> \"quotes\"" },
+				{ "kind", "package" } } );
+    }
+    return str.str();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(xml_search_sink)
+{
+  BOOST_CHECK_EQUAL( viaSink( 0 ), "" );	// no results, no <search-result>
+  BOOST_CHECK_EQUAL( viaSink( 3 ), viaTable( 3 ) );
+}
+
+BOOST_AUTO_TEST_CASE(xml_search_sink_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  const unsigned rows = 200000;
+  BOOST_CHECK_EQUAL( viaSink( rows ).size(), viaTable( rows ).size() );
+}
@@ -0,0 +1,43 @@
+#ifndef INCLUDE_TESTHELPERS
+#define INCLUDE_TESTHELPERS
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+
+/** Redirect cout to a string while in scope. */
+struct CaptureCout
+{
+  CaptureCout() : _buf( std::cout.rdbuf( _str.rdbuf() ) ) {}
+  ~CaptureCout() { std::cout.rdbuf( _buf ); }
+  std::string str() const { return _str.str(); }
+  void clear() { _str.str( "" ); }
+
+  std::ostringstream _str;
+  std::streambuf * _buf;
+};
+
+/** Print the time spent in scope to cerr. */
+struct Timer
+{
+  Timer( const char * name_r ) : _name( name_r ), _start( std::chrono::steady_clock::now() ) {}
+  ~Timer()
+  {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - _start ).count();
+    std::cerr << _name << ":\t" << ms << " ms" << std::endl;
+  }
+  const char * _name;
+  std::chrono::steady_clock::time_point _start;
+};
+
+/** Whether to run the benchmark test cases. They take long and only print
+ * timings, so they are skipped unless \c ZYPPER_TEST_BENCHMARKS is set:
+ * \code
+ *   ZYPPER_TEST_BENCHMARKS=1 ctest -R ParallelQuery --output-on-failure
+ * \endcode
+ */
+inline bool runBenchmarks()
+{ return ::getenv( "ZYPPER_TEST_BENCHMARKS" ); }
+
+#endif // INCLUDE_TESTHELPERS
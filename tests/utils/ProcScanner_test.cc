@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "TestSetup.h"
+#include "utils/ProcScanner.h"
+
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(deleted_file_in_maps_line)
+{
+  string file;
+  BOOST_CHECK( ProcScanner::deletedFileInMapsLine( "7f2c1000-7f2c2000 r-xp 00000000 08:01 1234                       /usr/lib64/libfoo.so.1 (deleted)", file ) );
+  BOOST_CHECK_EQUAL( file, "/usr/lib64/libfoo.so.1" );
+  BOOST_CHECK( ProcScanner::deletedFileInMapsLine( "7f2c1000-7f2c2000 r--p 00000000 08:01 1234 /opt/with blank (deleted)", file ) );
+  BOOST_CHECK_EQUAL( file, "/opt/with blank" );
+
+  BOOST_CHECK( ! ProcScanner::deletedFileInMapsLine( "7f2c1000-7f2c2000 r-xp 00000000 08:01 1234   /usr/lib64/libfoo.so.1", file ) );
+  BOOST_CHECK( ! ProcScanner::deletedFileInMapsLine( "7f2c1000-7f2c2000 rw-s 00000000 00:05 98304  /SYSV00000000 (deleted)", file ) );
+  BOOST_CHECK( ! ProcScanner::deletedFileInMapsLine( "7f2c1000-7f2c2000 rw-s 00000000 00:01 2048   /memfd:wayland-shm (deleted)", file ) );
+  BOOST_CHECK( ! ProcScanner::deletedFileInMapsLine( "7f2c1000-7f2c2000 rw-s 00000000 00:05 4      /dev/zero (deleted)", file ) );
+  BOOST_CHECK( ! ProcScanner::deletedFileInMapsLine( "7f2c1000-7f2c2000 rw-p 00000000 00:00 0      [heap]", file ) );
+  BOOST_CHECK( ! ProcScanner::deletedFileInMapsLine( "", file ) );
+}
+
+BOOST_AUTO_TEST_CASE(scan_self)
+{
+  // map a file and delete it
+  string path( str::form( "/tmp/ProcScanner_test.%d", ::getpid() ) );
+  { ofstream( path ) << "deleted" << endl; }
+  int fd = ::open( path.c_str(), O_RDONLY );
+  BOOST_REQUIRE( fd >= 0 );
+  void * addr = ::mmap( nullptr, 8, PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+  BOOST_REQUIRE( addr != MAP_FAILED );
+  ::unlink( path.c_str() );
+
+  ProcScanner::FileSet files { path, "/no/such/file" };
+  ProcScanner scanner( 4 );
+  const ProcScanner::ProcInfoList & result( scanner.scan( &files ) );
+  BOOST_REQUIRE_EQUAL( result.size(), 1 );
+  BOOST_CHECK_EQUAL( result[0].pid, str::numstring( ::getpid() ) );
+  BOOST_CHECK_EQUAL( result[0].ppid, str::numstring( ::getppid() ) );
+  BOOST_CHECK_EQUAL( result[0].puid, str::numstring( ::getuid() ) );
+  BOOST_REQUIRE_EQUAL( result[0].files.size(), 1 );
+  BOOST_CHECK_EQUAL( result[0].files[0], path );
+
+  // unfiltered the file is found too
+  bool found = false;
+  for ( const auto & procInfo : scanner.scan() )
+  {
+    if ( procInfo.pid == str::numstring( ::getpid() ) )
+      found = ( find( procInfo.files.begin(), procInfo.files.end(), path ) != procInfo.files.end() );
+  }
+  BOOST_CHECK( found );
+
+  ::munmap( addr, 8 );
+  BOOST_CHECK( scanner.scan( &files ).empty() );
+}
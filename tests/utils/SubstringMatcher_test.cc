@@ -0,0 +1,74 @@
+#include <cstring>
+
+#include "TestSetup.h"
+#include "utils/SubstringMatcher.h"
+
+using namespace std;
+
+namespace
+{
+  vector<unsigned> found( const SubstringMatcher & matcher_r, const string & text_r )
+  {
+    vector<unsigned> ret;
+    matcher_r.find( text_r, ret );
+    return ret;
+  }
+
+  /** The patterns contained in \a text_r, the plain way (strcasestr). */
+  vector<unsigned> expected( const vector<string> & patterns_r, const string & text_r )
+  {
+    vector<unsigned> ret;
+    for ( unsigned idx = 0; idx < patterns_r.size(); ++idx )
+    {
+      if ( ::strcasestr( text_r.c_str(), patterns_r[idx].c_str() ) )
+	ret.push_back( idx );
+    }
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(substring_matcher)
+{
+  vector<string> patterns { "he", "she", "his", "hers", "CVE-2015-0235", "123", "1234" };
+  SubstringMatcher matcher( patterns );
+  BOOST_CHECK_EQUAL( matcher.size(), patterns.size() );
+
+  for ( const char * text : { "ushers", "this", "", "h", "cve-2015-0235", "CVE-2015-02351", "bnc#912345", "nothing" } )
+  {
+    BOOST_CHECK( found( matcher, text ) == expected( patterns, text ) );
+    BOOST_CHECK_EQUAL( matcher.matches( text ), ! expected( patterns, text ).empty() );
+  }
+
+  // results are appended
+  vector<unsigned> result { 42 };
+  matcher.find( "she", result );
+  BOOST_CHECK( result == vector<unsigned>({ 42, 0, 1 }) );
+}
+
+BOOST_AUTO_TEST_CASE(substring_matcher_empty)
+{
+  SubstringMatcher none( {} );
+  BOOST_CHECK( found( none, "text" ).empty() );
+  BOOST_CHECK( ! none.matches( "text" ) );
+
+  // an empty pattern is contained in any text
+  SubstringMatcher any( { "xyz", "" } );
+  BOOST_CHECK( found( any, "" ) == vector<unsigned>({ 1 }) );
+  BOOST_CHECK( found( any, "axyz" ) == vector<unsigned>({ 0, 1 }) );
+  BOOST_CHECK( any.matches( "abc" ) );
+}
+
+BOOST_AUTO_TEST_CASE(substring_matcher_many)
+{
+  // many CVE like IDs against many texts
+  vector<string> patterns;
+  for ( unsigned i = 0; i < 500; ++i )
+    patterns.push_back( "CVE-2015-" + to_string( 1000 + i * 7 ) );
+  SubstringMatcher matcher( patterns );
+
+  for ( unsigned i = 0; i < 4000; i += 3 )
+  {
+    string text( "cve-2015-" + to_string( 1000 + i ) + " and bnc#" + to_string( i ) );
+    BOOST_CHECK( found( matcher, text ) == expected( patterns, text ) );
+  }
+}
@@ -0,0 +1,75 @@
+#include <vector>
+
+#include "TestSetup.h"
+#include "TestHelpers.h"
+#include "utils/text.h"
+
+using namespace std;
+
+namespace
+{
+  /** mbs_width without the ASCII fast path */
+  size_t mbs_width_reference( boost::string_ref text_r )
+  {
+    size_t ret = 0;
+    for( mbs::MbsIterator it( text_r ); ! it.atEnd(); ++it )
+      ret += it.columns();
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mbs_width_fastpath)
+{
+  cout << "locale set to: " << setlocale (LC_CTYPE, "en_US.UTF-8") << endl;
+
+  // the fast path must not change the result
+  const char * texts[] = {
+    "",
+    "zypper",
+    "libzypp-devel-doc-16.0.0-1.1.x86_64",	// longer than a SSE2 register
+    "tab\there",				// WS counts 1
+    "line\n",					// NL counts 0
+    "\033[1;31mred\033[0m",			// SGR counts 0
+    "del\177",
+    "0123456789abcdefKoľko stĺpcov zaberajú znaky '和平'?",
+    "0123456789abcdef0123456789abcdef玄米茶",
+  };
+  for ( const char * text : texts )
+    BOOST_CHECK_EQUAL( mbs_width( text ), mbs_width_reference( text ) );
+
+  BOOST_CHECK_EQUAL( mbs_width( "0123456789abcdef0123456789abcdef玄米茶" ), 38 );
+  BOOST_CHECK_EQUAL( mbs_width( "\033[1;31mred\033[0m" ), 3 );
+}
+
+BOOST_AUTO_TEST_CASE(mbs_width_benchmark)
+{
+  if ( ! runBenchmarks() )
+    return;
+
+  setlocale (LC_CTYPE, "en_US.UTF-8");
+
+  // typical table cells: package names, versions, repo aliases
+  vector<string> texts;
+  for ( unsigned i = 0; i < 200000; ++i )
+  {
+    texts.push_back( str::form( "package-name-%u", i ) );
+    texts.push_back( str::form( "%u.%u.%u-lp152.%u.1", i % 7, i % 13, i % 31, i % 5 ) );
+    texts.push_back( "openSUSE-Leap-15.2-Update" );
+  }
+
+  size_t fast = 0;
+  {
+    Timer timer( "mbs_width" );
+    for ( unsigned round = 0; round < 10; ++round )
+      for ( const string & text : texts )
+	fast += mbs_width( text );
+  }
+  size_t slow = 0;
+  {
+    Timer timer( "MbsIterator" );
+    for ( unsigned round = 0; round < 10; ++round )
+      for ( const string & text : texts )
+	slow += mbs_width_reference( text );
+  }
+  BOOST_CHECK_EQUAL( fast, slow );
+}